@@ -1,35 +1,52 @@
 #include "File.hpp"
       
 std::string File::getName() const {
-   return filename_;
+   return filename_.str();
 }
 
 std::string File::getContents() const {
-   return contents_;
+   return contents_ ? *contents_ : std::string();
+}
+
+std::string_view File::getNameView() const {
+   return filename_.view();
+}
+
+const FileName& File::getFileName() const {
+   return filename_;
+}
+
+std::string_view File::getContentsView() const {
+   return contents_ ? std::string_view(*contents_) : std::string_view();
 }
 
 void File::setContents(const std::string& new_contents) {
-   contents_ = new_contents;
+   // never write through the shared buffer; other copies keep the old one
+   contents_ = std::make_shared<const std::string>(new_contents);
 }
 
-int* File::getIcon() const {
-   return icon_;
+const uint8_t* File::getIcon() const {
+   return icon_.pixels();
 }
 
 void File::setIcon(int* new_icon) {
-   if (icon_) { delete[] icon_; }
-   icon_ = new_icon;
+   icon_ = Icon::fromInts(new_icon);
+   delete[] new_icon;   // the pixels now live in the icon pool
 } 
 
+void File::setIcon(const Icon& new_icon) {
+   icon_ = new_icon;
+}
+
 std::ostream& operator<< (std::ostream& os, const File& target) {
-   os << "Name: " << target.getName() << std::endl;
+   os << "Name: " << target.getNameView() << std::endl;
    os << "Size: " << target.getSize() << " bytes" << std::endl;
-   os << "Contents: " << target.getContents(); 
+   os << "Contents: " << target.getContentsView(); 
    return os;
 }
 
 bool File::operator<(const File& rhs) const {
-   return getName() < rhs.getName();
+   return filename_ < rhs.filename_;
 }
 
 //                       DO NOT EDIT ABOVE THIS LINE. 
@@ -50,48 +67,73 @@ bool File::operator<(const File& rhs) const {
  *    - If no extension is provided (e.g. there is no period within the provided filename) or nothing follows the period, then ".txt" is used as the extension
  *    - Default value of "NewFile.txt" if none provided or if filename is empty 
  * @param contents A string representing the contents of the file. Default to empty string if none provided.
- * @param icon A pointer to a [dynamically allocated] integer array with length ICON_DIM. Default to nullptr if none provided.
+ * @param icon A pointer to a [dynamically allocated] integer array with length ICON_DIM, interned as 8-bit pixels and then de-allocated.
+ *    Default to nullptr if none provided.
  * @throws InvalidFormatException - An error that occurs if the filename is not valid by the above constraints.
  * @note You'll notice we provide a default value for the first possible argument (filename)
  *       Yes, this means we can define override the default constructor and define a parameterized one simultaneously.
  */
-File::File(const std::string& filename, const std::string& contents, int* icon) {
+File::File(const std::string& filename, const std::string& contents, int* icon) : filename_{normalizeName(filename)} {
     // std::cout<< "calling basic constructor on " << this << std::endl;
-    // check if filename is valid
-    int numberOfPeriods = 0;
-    for (int i = 0; i < filename.length(); i++) {
-        // check if this char is a period
-        if (filename[i] == '.') {
-            numberOfPeriods++;
-        }
-        // if not period, check if alnum
-        else if (!isalnum(filename[i])) {
-            throw InvalidFormatException();
-        }
-        // if too many periods, throw exception
-        if (numberOfPeriods > 1) {
-            throw InvalidFormatException();
-        }
-    }
+    // the name was validated (16-32 characters per step) and given its defaults above
+    contents_ = std::make_shared<const std::string>(contents);
+    icon_ = Icon::fromInts(icon);
+    delete[] icon;          // icon has dynamic memory; its pixels now live in the icon pool
+
+}
+
+/**
+ * @brief Constructs a new File object using an already interned icon
+ * @see File(const std::string&, const std::string&, int*)
+ */
+File::File(const std::string& filename, const std::string& contents, const Icon& icon) : File(filename, contents) {
+    icon_ = icon;
+}
+
+/**
+ * @brief Constructs an empty File from an already validated and normalized filename
+ * @note Public so std::vector can construct Files in place, but only File can supply the tag
+ */
+File::File(FileName&& normalized_name, NormalizedTag) : filename_{std::move(normalized_name)}, contents_{}, icon_{} {}
+
+/**
+ * @brief Validates a filename and applies the constructor's defaults (NewFile.txt, the .txt extension)
+ * @return The filename as it will be stored
+ * @throws InvalidFormatException if the filename is not valid
+ */
+FileName File::normalizeName(const std::string& filename) {
     // if the filename is empty
     if (filename == "") {
-        filename_ = "NewFile.txt";
+        return FileName("NewFile.txt");
     }
-    // if there is no extension after the period
-    else if (filename[filename.length() - 1] == '.') {
-        filename_ = filename + "txt";
+    // check if filename is valid: only alphanumeric characters and at most one period
+    FilenameCheck check = checkFilename(filename.data(), filename.size());
+    if (!check.valid_) {
+        throw InvalidFormatException();
     }
-    // if there is no period
-    else if (numberOfPeriods == 0) {
-        filename_ = filename + ".txt";
+    // if the filename is valid and has an extension, keep it as is
+    if (check.period_ != std::string::npos && check.period_ + 1 < filename.size()) {
+        return FileName(filename);
     }
-    // if the filename is valid
-    else {
-        filename_ = filename;
-    }
-    contents_ = contents;
-    icon_ = icon;           // icon has dynamic memory
+    // if there is no period, or no extension after it, join the base and the default extension in place
+    size_t base_length = (check.period_ == std::string::npos) ? filename.size() : check.period_;
+    return FileName(std::string_view(filename).substr(0, base_length), ".txt");
+}
 
+/**
+ * @brief Constructs one File per name, validating and normalizing the whole batch into storage reserved up front
+ * 
+ * @param names The filenames, with the same rules as the constructor
+ * @return The new Files (with empty contents and no icon), in the order of names
+ * @throws InvalidFormatException if any name is invalid
+ */
+std::vector<File> File::fromNames(const std::vector<std::string>& names) {
+    std::vector<File> files;
+    files.reserve(names.size());
+    for (const std::string& name : names) {
+        files.emplace_back(normalizeName(name), NormalizedTag{});
+    }
+    return files;
 }
 
 /**
@@ -100,39 +142,22 @@ File::File(const std::string& filename, const std::string& contents, int* icon)
  * @note Consider this: how does this relate to the string's length? Why is that the case?
  */
 size_t File::getSize() const {
-    // icon_ should be 4 * ICON_DIM bytes if it's not null ptr
-    // int iconSize = (icon_ == nullptr) ? sizeof(icon_) : sizeof(icon_) + sizeof(int) * ICON_DIM;
-    return contents_.size();
+    return contents_ ? contents_->size() : 0;
 }
 
 /**
- * @brief (COPY CONSTRUCTOR) Constructs a new File object as a deep copy of the target File
+ * @brief (COPY CONSTRUCTOR) Constructs a new File object as a copy of the target File
+ * The contents buffer and icon are shared rather than duplicated, so this is constant-time in their size;
+ *    they are only duplicated in effect when either File later replaces them.
  * @param rhs A const reference to the file to be copied from
  */
-File::File(const File& rhs) {
+File::File(const File& rhs) : filename_{rhs.filename_}, contents_{rhs.contents_}, icon_{rhs.icon_} {
     // std::cout<< "calling copy constructor on " << this << " to copy " << std::addressof(rhs) << std::endl;
-    filename_ = rhs.getName();
-    contents_ = rhs.getContents();
-
-    // if rhs.getIcon() is nullptr, set to nullptr
-    int* shallow = rhs.getIcon();
-    if (shallow == nullptr) {
-        // can't use setIcon here. setIcon is only reliable if icon_ has been initialized already
-        // if icon_ is not set to nullptr, it might attempt to delete[] memory that doesn't exist
-        icon_ = nullptr;        
-    }
-    // else, do a deep copy
-    else {
-        // create a new array with dynamic memory
-        icon_ = new int[ICON_DIM];
-        for(int i = 0; i < ICON_DIM; i++) {
-            icon_[i] = shallow[i];
-        }
-    }
 }
 
 /**
- * @brief (COPY ASSIGNMENT) Replaces the calling File's data members using a deep copy of the rhs File.
+ * @brief (COPY ASSIGNMENT) Replaces the calling File's data members using a copy of the rhs File.
+ * As with the copy constructor, the contents buffer and icon are shared rather than duplicated.
  * 
  * @param rhs A const reference to the File object to be copied
  * @return A reference to the new File copy
@@ -146,30 +171,10 @@ File& File::operator=(const File& rhs) {
 
     // std::cout<< "calling copy assignment on " << this << " to copy " << std::addressof(rhs) << std::endl;
 
-    filename_ = rhs.getName();
-    contents_ = rhs.getContents();
-
-    int* shallow = rhs.getIcon();
-    // if rhs.getIcon() is nullptr, set to nullptr
-    if (shallow == nullptr) {
-        // use setIcon to take care of deleting the existing icon
-        setIcon(nullptr);
-    }
-    // if icon_ is currently nullptr, we must create a new array
-    else if (icon_ == nullptr) {
-        int* deep = new int[ICON_DIM];
-        for(int i = 0; i < ICON_DIM; i++) {
-            deep[i] = shallow[i];
-        }
-        // use setIcon to take care of deleting the existing icon
-        setIcon(deep);
-    }
-    // if icon_ is not nullptr, we can just override existing values
-    else if (icon_ != nullptr) {
-        for(int i = 0; i < ICON_DIM; i++) {
-            icon_[i] = shallow[i];
-        }
-    }
+    filename_ = rhs.filename_;
+    // our previous buffers are released only if no other File still shares them
+    contents_ = rhs.contents_;
+    icon_ = rhs.icon_;
 
     return *this;
 }
@@ -184,10 +189,9 @@ File& File::operator=(const File& rhs) {
 File::File(File&& rhs) {
     // std::cout<< "calling move constructor on " << this << " to move " << std::addressof(rhs) << std::endl;
     filename_ = std::move(rhs.filename_);
+    // moving a shared_ptr leaves the source null
     contents_ = std::move(rhs.contents_);
     icon_ = std::move(rhs.icon_);
-    
-    rhs.icon_ = nullptr;
 }
 
 /**
@@ -210,18 +214,14 @@ File& File::operator=(File&& rhs) {
     contents_ = std::move(rhs.contents_);
     icon_ = std::move(rhs.icon_);
 
-    rhs.icon_ = nullptr;
-
     return *this;
 }
 
 /**
  * @brief (DESTRUCTOR) Routine for object deletion
- * @post All dynamically allocated memory is released
+ * @post All dynamically allocated memory no longer shared with another File is released
  */
 File::~File() {
     // std::cout<< "calling destructor on " << this << std::endl;
-    if (icon_ != nullptr) {
-        delete[] icon_;
-    }
+    // contents_ and icon_ release their storage once the last File sharing them is gone
 }
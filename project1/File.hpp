@@ -1,15 +1,35 @@
 #pragma once
 
 #include "InvalidFormatException.hpp"
+#include "Icon.hpp"
+#include "FilenameValidator.hpp"
+#include "FileName.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 class File {
    private:
-      std::string filename_;
-      std::string contents_;
-      int* icon_;
+      FileName filename_;   // Stored inline for names up to FileName::INLINE_CAPACITY bytes
+      // Contents are an immutable buffer shared between copies: copying a File only bumps a reference count,
+      // and a write installs a new buffer for this File alone (copy-on-write). A null buffer means empty contents.
+      std::shared_ptr<const std::string> contents_;
+      // Icons are interned 8-bit bitmaps, so identical icons are stored once no matter how many Files use them
+      Icon icon_;
 
       static const size_t ICON_DIM = 256; // Representing a 16 x 16 bitmap
 
+      // Marks a filename that has already been through normalizeName(). Only File can create one.
+      struct NormalizedTag {};
+
+      /**
+       * @brief Validates a filename and applies the constructor's defaults (NewFile.txt, the .txt extension)
+       * @return The filename as it will be stored
+       * @throws InvalidFormatException if the filename is not valid
+       */
+      static FileName normalizeName(const std::string& filename);
+
    public: 
       /**
        * @brief Enables printing the object via std::cout
@@ -32,6 +52,23 @@ class File {
        */
       std::string getContents() const;
 
+      /**
+       * @brief Get a read-only view of filename_, without copying it
+       * @note The view is invalidated when the File is modified, moved from or destroyed
+       */
+      std::string_view getNameView() const;
+
+      /**
+       * @brief Get the stored name, with its precomputed hash and extension position
+       */
+      const FileName& getFileName() const;
+
+      /**
+       * @brief Get a read-only view of the contents, without copying them
+       * @note The view stays valid until this File's contents are replaced or the File is destroyed
+       */
+      std::string_view getContentsView() const;
+
       /**
        * @brief Set the value of contents_ to the provided string
        * 
@@ -41,16 +78,24 @@ class File {
 
 
       /**
-       * @brief Gets the value of the icon_ member
+       * @brief Gets the pixels of the icon_ member, or nullptr if the File has no icon
+       * @note The bitmap is interned and shared with every File using the same icon, so it is read-only. Use setIcon to change it.
        */
-      int* getIcon() const;
+      const uint8_t* getIcon() const;
 
       /**
-       * @brief Sets the value of icon_ to the given parameter. De-allocates the previous array if necessary.
-       * @param new_icon A pointer to a length 256 (ie. ICON_DIM) array of unsigned 8 bit integers
+       * @brief Sets the value of icon_ to the given parameter. The previous bitmap is released once no File uses it.
+       * @param new_icon A pointer to a [dynamically allocated] length 256 (ie. ICON_DIM) array of unsigned 8 bit integers, or nullptr for no icon.
+       *    The values are interned as 8-bit pixels and the array is de-allocated before setIcon returns,
+       *    so the caller must not keep or use new_icon afterwards.
        */
       void setIcon(int* new_icon); 
 
+      /**
+       * @brief Sets the value of icon_ to an already interned icon
+       */
+      void setIcon(const Icon& new_icon);
+
       //                       DO NOT EDIT ABOVE THIS LINE. 
       //                  (with exceptions to include statements)
       // =========================== YOUR CODE HERE ===========================
@@ -63,13 +108,35 @@ class File {
       *    - If no extension is provided (e.g. there is no period within the provided filename) or nothing follows the period, then ".txt" is used as the extension
       *    - Default value of "NewFile.txt" if none provided or if filename is empty 
       * @param contents A string representing the contents of the file. Default to empty string if none provided.
-      * @param icon A pointer to an integer array with length ICON_DIM. Default to nullptr if none provided.
+      * @param icon A pointer to a [dynamically allocated] integer array with length ICON_DIM, interned as 8-bit pixels and then de-allocated.
+      *    Default to nullptr if none provided.
       * @throws InvalidFormatException - An error that occurs if the filename is not valid by the above constraints.
       * @note You'll notice we provide a default value for the first possible argument (filename)
       *       Yes, this means we can define override the default constructor and define a parameterized one simultaneously.
       */
       File(const std::string& filename = "NewFile.txt", const std::string& contents = "", int* icon = nullptr);
 
+      /**
+      * @brief Constructs a new File object using an already interned icon
+      * @see File(const std::string&, const std::string&, int*)
+      */
+      File(const std::string& filename, const std::string& contents, const Icon& icon);
+
+      /**
+       * @brief Constructs an empty File from an already validated and normalized filename
+       * @note Public so std::vector can construct Files in place, but only File can supply the tag
+       */
+      File(FileName&& normalized_name, NormalizedTag);
+
+      /**
+       * @brief Constructs one File per name, validating and normalizing the whole batch into storage reserved up front
+       * 
+       * @param names The filenames, with the same rules as the constructor
+       * @return The new Files (with empty contents and no icon), in the order of names
+       * @throws InvalidFormatException if any name is invalid
+       */
+      static std::vector<File> fromNames(const std::vector<std::string>& names);
+
 
       /**
       * @brief Calculates and returns the size of the File Object (IN BYTES), using .size()
@@ -80,14 +147,17 @@ class File {
 
 
       /**
-       * @brief (COPY CONSTRUCTOR) Constructs a new File object as a deep copy of the target File
+       * @brief (COPY CONSTRUCTOR) Constructs a new File object as a copy of the target File
+       * The contents buffer and icon are shared rather than duplicated, so this is constant-time in their size;
+       *    they are only duplicated in effect when either File later replaces them.
        * @param rhs A const reference to the file to be copied from
        */
       File(const File& rhs);
 
 
       /**
-       * @brief (COPY ASSIGNMENT) Replaces the calling File's data members using a deep copy of the rhs File.
+       * @brief (COPY ASSIGNMENT) Replaces the calling File's data members using a copy of the rhs File.
+       * As with the copy constructor, the contents buffer and icon are shared rather than duplicated.
        * 
        * @param rhs A const reference to the File object to be copied
        * @return A reference to the new File copy
@@ -121,7 +191,7 @@ class File {
       
       /**
        * @brief (DESTRUCTOR) Routine for object deletion
-       * @post All dynamically allocated memory is released
+       * @post All dynamically allocated memory no longer shared with another File is released
        */
       ~File();
 };
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "FileName.hpp"
+#include <cstring>
+#include <functional>
+
+/**
+ * @brief Allocates (if needed) and zero-fills storage for length characters, and records the length
+ * @return The storage to write the characters into
+ */
+char* FileName::allocate(size_t length) {
+    length_ = static_cast<uint32_t>(length);
+    if (spilled()) {
+        heap_.characters_ = new char[length];
+        return heap_.characters_;
+    }
+    std::memset(inline_, 0, sizeof(inline_));
+    return inline_;
+}
+
+/**
+ * @brief Computes the period position and hash once the characters are in place
+ */
+void FileName::finish() {
+    std::string_view characters = view();
+    size_t found = characters.rfind('.');
+    uint32_t period = (found == std::string_view::npos) ? length_ : static_cast<uint32_t>(found);
+    if (spilled()) {
+        heap_.period_ = period;
+    } else {
+        // at most INLINE_CAPACITY, so it fits in the spare byte
+        inline_[INLINE_CAPACITY] = static_cast<char>(period);
+    }
+    hash_ = hashOf(characters);
+}
+
+/**
+ * @brief Frees heap storage, if any, leaving the empty name
+ */
+void FileName::reset() {
+    if (spilled()) {
+        delete[] heap_.characters_;
+    }
+    std::memset(inline_, 0, sizeof(inline_));
+    length_ = 0;
+    hash_ = hashOf(std::string_view());
+}
+
+/**
+ * @brief Constructs the empty name (also the state of a moved-from FileName)
+ */
+FileName::FileName() : length_{0} {
+    reset();
+}
+
+/**
+ * @brief Constructs a name holding a copy of the given characters
+ */
+FileName::FileName(std::string_view name) {
+    std::memcpy(allocate(name.size()), name.data(), name.size());
+    finish();
+}
+
+/**
+ * @brief Constructs the concatenation of base and suffix, without building a temporary string
+ */
+FileName::FileName(std::string_view base, std::string_view suffix) {
+    char* characters = allocate(base.size() + suffix.size());
+    std::memcpy(characters, base.data(), base.size());
+    std::memcpy(characters + base.size(), suffix.data(), suffix.size());
+    finish();
+}
+
+FileName::FileName(const FileName& rhs) : length_{rhs.length_}, hash_{rhs.hash_} {
+    if (rhs.spilled()) {
+        heap_.characters_ = new char[length_];
+        heap_.period_ = rhs.heap_.period_;
+        std::memcpy(heap_.characters_, rhs.heap_.characters_, length_);
+    } else {
+        std::memcpy(inline_, rhs.inline_, sizeof(inline_));
+    }
+}
+
+FileName& FileName::operator=(const FileName& rhs) {
+    if (this != &rhs) {
+        FileName copy(rhs);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+FileName::FileName(FileName&& rhs) noexcept : length_{rhs.length_}, hash_{rhs.hash_} {
+    // copying the union moves a heap pointer and period or the inline characters alike
+    std::memcpy(inline_, rhs.inline_, sizeof(inline_));
+    rhs.length_ = 0;
+    rhs.reset();
+}
+
+FileName& FileName::operator=(FileName&& rhs) noexcept {
+    if (this != &rhs) {
+        reset();
+        std::memcpy(inline_, rhs.inline_, sizeof(inline_));
+        length_ = rhs.length_;
+        hash_ = rhs.hash_;
+        rhs.length_ = 0;
+        rhs.reset();
+    }
+    return *this;
+}
+
+FileName::~FileName() {
+    if (spilled()) {
+        delete[] heap_.characters_;
+    }
+}
+
+/**
+ * @brief Two names are equal when their characters are. Differing hashes or lengths reject a mismatch without touching the characters.
+ */
+bool FileName::operator==(const FileName& rhs) const {
+    if (hash_ != rhs.hash_ || length_ != rhs.length_) {
+        return false;
+    }
+    if (spilled()) {
+        return std::memcmp(heap_.characters_, rhs.heap_.characters_, length_) == 0;
+    }
+    // both are inline and zero padded, and equal characters give equal periods, so the whole buffers can be compared
+    //    a word at a time
+    return std::memcmp(inline_, rhs.inline_, sizeof(inline_)) == 0;
+}
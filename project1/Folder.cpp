@@ -1,12 +1,24 @@
 #include "Folder.hpp"
 
+/**
+ * @brief Returns the number of bits needed to represent n (0 for n == 0), ie. its FolderStats histogram bucket
+ */
+inline size_t bitWidth(size_t n) {
+   size_t width = 0;
+   while (n) {
+      n >>= 1;
+      width++;
+   }
+   return width;
+}
+
 /**
 * @brief Construct a new Folder object
 * @param name A string with alphanumeric characters.
    If the folder name is empty / none is provided, default value of "NewFolder" is used. 
 * @throw If the name is invalid (eg. contains non-alphanumeric characters) an InvalidFormatException is thrown
 */
-Folder::Folder(const std::string& name) : name_{"NewFolder"} {
+Folder::Folder(const std::string& name) : name_{"NewFolder"}, files_{}, index_{}, order_{}, rank_{}, sorted_{0}, vacant_{0}, stats_{}, size_counts_{} {
    if (name.empty()) { return; }
 
    for (const char& c : name) {
@@ -19,6 +31,30 @@ Folder::Folder(const std::string& name) : name_{"NewFolder"} {
    name_ = name;
 }
 
+/**
+ * @brief Copy Constructor: Deep copies the folder, its files and, recursively, its subfolders
+ * @note The name index and sorted view hold slots rather than pointers, so they are copied as they are
+ */
+Folder::Folder(const Folder& rhs) : name_{rhs.name_}, files_{rhs.files_}, index_{rhs.index_}, order_{rhs.order_}, rank_{rhs.rank_},
+      sorted_{rhs.sorted_}, vacant_{rhs.vacant_}, stats_{rhs.stats_}, size_counts_{rhs.size_counts_}, subfolders_{} {
+   subfolders_.reserve(rhs.subfolders_.size());
+   for (const std::unique_ptr<Folder>& subfolder : rhs.subfolders_) {
+      subfolders_.push_back(std::make_unique<Folder>(*subfolder));
+   }
+}
+
+/**
+ * @brief Copy Assignment: Replaces this folder's files and subfolders with deep copies of rhs's
+ */
+Folder& Folder::operator=(const Folder& rhs) {
+   if (this != &rhs) {
+      // copy first, so a throwing copy leaves this folder untouched
+      Folder copy(rhs);
+      *this = std::move(copy);
+   }
+   return *this;
+}
+
 /**
    * @brief Get the value stored in name_
    * @return std::string 
@@ -45,26 +81,28 @@ bool Folder::rename(const std::string& name) {
 
 /**
 * @brief Sorts and prints the names of subfolder and file vectors lexicographically (ie. alphabetically)
-* The contents of subfolders are not printed.
+* The contents of subfolders are also printed, one directory layer deeper.
 * Reference the following format (using 3 spaces to indent the contained filenames)
 * <CURRENT_FOLDER_NAME> 
-*    <SUBFOLDER1_NAME> 
-*    <SUBFOLDER2_NAME> 
+*    (FOLDER) <SUBFOLDER1_NAME> 
+*       <SUBFOLDER1_FILENAME_1>
+*       ...
+*    (FOLDER) <SUBFOLDER2_NAME> 
 *    ...
-*    <SUBFOLDER_N_NAME> 
+*    (FOLDER) <SUBFOLDER_N_NAME> 
 *    <FILENAME_1>
 *    <FILENAME_2>
 *     ...
 *    <FILENAME_N>
 * 
-* @note: This CAN be done more efficiently by maintaining sorted order in the vectors already, instead of sorting each time we print. 
-*    However, we'll hold off on that for now, since we just want to get used to iterating with iterators.
+* @note: Sorted order is maintained in order_ (a permutation of slots) rather than in files_ itself: 
+*    only files appended since the last call need sorting before they are merged in.
+*    Subfolders are rendered into their own buffers in parallel, then joined in order and written with a single flush.
 */
 void Folder::display() {
-   std::sort(files_.begin(), files_.end());
-
-   std::cout << getName() << std::endl;
-   for (auto it = files_.begin(); it != files_.end(); ++it) { std::cout << "   " << it->getName() << std::endl; }
+   std::string out;
+   render(out, 0);
+   std::cout << out << std::flush;
 }
 
 //                       DO NOT EDIT ABOVE THIS LINE. 
@@ -73,15 +111,205 @@ void Folder::display() {
 // =========================== YOUR CODE HERE ===========================
 
 /**
- * @brief Iterate through the files vector, calculating the total size of all child files
+ * @brief Returns the total size of all child files, maintained as files are added, removed or changed
  * @return size_t The total size of all child files
  */
 size_t Folder::getSize() const {
-    int size = 0;
-    for(auto it = files_.begin(); it != files_.end(); ++it) {
-        size += (*it).getSize();
+    return stats_.total_bytes_;
+}
+
+/**
+ * @brief Returns the running aggregates (total bytes, file count, min/max size, size histogram) in constant time
+ */
+const FolderStats& Folder::getStats() const {
+    return stats_;
+}
+
+/**
+ * @brief Adds a file of the given size to stats_
+ */
+void Folder::recordSize(size_t size) {
+    stats_.total_bytes_ += size;
+    stats_.file_count_++;
+    stats_.histogram_[bitWidth(size)]++;
+
+    size_counts_[size]++;
+    stats_.min_size_ = size_counts_.begin()->first;
+    stats_.max_size_ = size_counts_.rbegin()->first;
+}
+
+/**
+ * @brief Removes a file of the given size from stats_
+ */
+void Folder::forgetSize(size_t size) {
+    stats_.total_bytes_ -= size;
+    stats_.file_count_--;
+    stats_.histogram_[bitWidth(size)]--;
+
+    auto it = size_counts_.find(size);
+    if (--it->second == 0) {
+        size_counts_.erase(it);
+    }
+    stats_.min_size_ = size_counts_.empty() ? 0 : size_counts_.begin()->first;
+    stats_.max_size_ = size_counts_.empty() ? 0 : size_counts_.rbegin()->first;
+}
+
+/**
+ * @brief Replaces the contents of the file with the given name, keeping the folder statistics current
+ * 
+ * @param name The name of the file to be modified
+ * @param contents The new contents of the file
+ * @return True if the file was found and modified. False otherwise.
+ */
+bool Folder::setFileContents(const std::string& name, const std::string& contents) {
+    size_t slot = index_.find(name, files_);
+    if (slot == NameIndex::NOT_FOUND) {
+        return false;
+    }
+    forgetSize(files_[slot].getSize());
+    files_[slot].setContents(contents);
+    recordSize(files_[slot].getSize());
+    return true;
+}
+
+/**
+ * @brief Drops the VACANT entries of order_ and merges the unsorted tail into the sorted prefix
+ * @post order_ is fully sorted, holds exactly one entry per file, and rank_ matches it
+ */
+void Folder::refreshOrder() {
+    // compact away removed entries, keeping track of how much of the sorted prefix survives
+    size_t kept = 0;
+    size_t kept_sorted = 0;
+    for (size_t i = 0; i < order_.size(); i++) {
+        if (order_[i] == VACANT) { continue; }
+        if (i < sorted_) { kept_sorted++; }
+        order_[kept++] = order_[i];
+    }
+    order_.resize(kept);
+    vacant_ = 0;
+
+    // sort only what was appended, then merge it with the already sorted prefix
+    auto by_name = [this](size_t lhs, size_t rhs) { return files_[lhs] < files_[rhs]; };
+    std::sort(order_.begin() + kept_sorted, order_.end(), by_name);
+    std::inplace_merge(order_.begin(), order_.begin() + kept_sorted, order_.end(), by_name);
+    sorted_ = order_.size();
+
+    for (size_t i = 0; i < order_.size(); i++) {
+        rank_[order_[i]] = i;
+    }
+}
+
+/**
+ * @brief Appends a file, recording its name in the name index and the file in the sorted view
+ * @pre No file with the same name exists within files_
+ */
+void Folder::appendFile(File&& file) {
+    index_.insert(file.getFileName(), files_.size());
+    // new files go to the unsorted tail of order_; display() merges them in
+    rank_.push_back(order_.size());
+    order_.push_back(files_.size());
+    recordSize(file.getSize());
+    files_.push_back(std::move(file));
+}
+
+/**
+ * @brief Moves the file out of the given slot and fills the slot with the last file (ie. swap-erase)
+ * @pre The index entry of the file at slot has already been erased
+ * @return The file previously stored at slot
+ */
+File Folder::takeSlot(size_t slot) {
+    // leave a hole in order_ rather than shifting it; refreshOrder() compacts the holes later
+    order_[rank_[slot]] = VACANT;
+    vacant_++;
+
+    File taken = std::move(files_[slot]);
+    forgetSize(taken.getSize());
+    size_t last = files_.size() - 1;
+    if (slot != last) {
+        // the last file takes over the vacated slot, so its index and order entries must follow it
+        order_[rank_[last]] = slot;
+        rank_[slot] = rank_[last];
+        index_.relocate(files_[last].getFileName(), last, slot);
+        files_[slot] = std::move(files_[last]);
+    }
+    files_.pop_back();
+    rank_.pop_back();
+
+    // don't let holes outgrow the live entries when display() is rarely called
+    if (vacant_ > files_.size()) {
+        refreshOrder();
+    }
+    return taken;
+}
+
+/**
+ * @brief Makes room for extra more files without reallocating files_ or its bookkeeping
+ */
+void Folder::reserveFor(size_t extra) {
+    files_.reserve(files_.size() + extra);
+    rank_.reserve(files_.size() + extra);
+    order_.reserve(order_.size() + extra);
+    index_.reserve(files_.size() + extra);
+}
+
+/**
+ * @brief Removes the files at the given slots in one pass, optionally moving them into destination
+ * @pre The index entries of the files at slots have already been erased, and no slot is listed twice
+ * @param slots The slots to remove (reordered by the call)
+ * @param destination The folder the removed files are appended to, or nullptr to delete them
+ */
+void Folder::extractSlots(std::vector<size_t>& slots, Folder* destination) {
+    if (slots.size() * COMPACT_RATIO < files_.size()) {
+        // highest slot first, so the file swapped into each hole is never one still waiting to be taken
+        std::sort(slots.begin(), slots.end(), std::greater<size_t>());
+        for (size_t slot : slots) {
+            File taken = takeSlot(slot);
+            if (destination) {
+                destination->appendFile(std::move(taken));
+            }
+        }
+        return;
+    }
+
+    // remap[slot] is where a surviving file ends up; VACANT marks the ones being taken
+    std::vector<size_t> remap(files_.size(), 0);
+    for (size_t slot : slots) {
+        remap[slot] = VACANT;
+        forgetSize(files_[slot].getSize());
+        if (destination) {
+            destination->appendFile(std::move(files_[slot]));
+        }
+    }
+
+    // one erase-remove style sweep, shifting the survivors down over the holes
+    size_t kept = 0;
+    for (size_t slot = 0; slot < files_.size(); slot++) {
+        if (remap[slot] == VACANT) { continue; }
+        remap[slot] = kept;
+        if (kept != slot) {
+            files_[kept] = std::move(files_[slot]);
+        }
+        kept++;
+    }
+    files_.erase(files_.begin() + kept, files_.end());
+
+    // survivors keep their place in the sorted view, only their slot numbers change
+    rank_.resize(kept);
+    for (size_t i = 0; i < order_.size(); i++) {
+        if (order_[i] == VACANT) { continue; }
+        if (remap[order_[i]] == VACANT) {
+            order_[i] = VACANT;
+            vacant_++;
+        } else {
+            order_[i] = remap[order_[i]];
+            rank_[order_[i]] = i;
+        }
+    }
+    index_.remap(remap);
+
+    if (vacant_ > files_.size()) {
+        refreshOrder();
     }
-    return size;
 }
 
 /**
@@ -93,37 +321,35 @@ size_t Folder::getSize() const {
  * @post If the file was added, leaves the parameter File object in a valid but unspecified state
  */
 bool Folder::addFile(File& new_file) {
+    std::string_view name = new_file.getNameView();
     // if file is empty return false
-    if (new_file.getName() == "") {
+    if (name.empty()) {
         return false;
     }
 
     // check if file with the same name exists
-    for(auto it = files_.begin(); it != files_.end(); ++it) {
-        if ((*it).getName() == new_file.getName()) {
-            return false;
-        }
+    if (index_.find(name, files_) != NameIndex::NOT_FOUND) {
+        return false;
     }
-    files_.push_back(std::move(new_file));
+    appendFile(std::move(new_file));
     return true;
 }
 
 /**
  * @brief Searches for a file within the files_ vector to be deleted.
  * If a file object with a matching name is found, erase it from the vector in linear [O(N)] time or better.
- * Order does not matter.
+ * Order does not matter: the last file is moved into the vacated slot, so removal is O(1) expected.
  * 
  * @param name A const reference to a string representing the filename to be deleted
  * @return True if the file was found & successfully deleted. 
  */
 bool Folder::removeFile(const std::string& name) {
-    for(auto it = files_.begin(); it != files_.end(); ++it) {
-        if ((*it).getName() == name) {
-            it = files_.erase(it);
-            return true;
-        }
+    size_t slot = index_.erase(name, files_);
+    if (slot == NameIndex::NOT_FOUND) {
+        return false;
     }
-    return false;
+    takeSlot(slot);
+    return true;
 }
 
 /**
@@ -144,24 +370,18 @@ bool Folder::moveFileTo(const std::string& name, Folder& destination) {
         return true;
     }
     // check if the destination has a file of the same name
-    for(auto it = destination.files_.begin(); it != destination.files_.end(); ++it) {
-        if ((*it).getName() == name) {
-            // if dupe exists, don't move and return false
-            return false;
-        }
+    if (destination.index_.find(name, destination.files_) != NameIndex::NOT_FOUND) {
+        // if dupe exists, don't move and return false
+        return false;
     }
-    // search for file by name and move it
-    for(auto it = files_.begin(); it != files_.end(); ++it) {
-        if ((*it).getName() == name) {
-            // move
-            destination.files_.push_back(std::move(*it));
-
-            // erase
-            it = files_.erase(it);
-            return true;
-        }
+    // search for file by name and unindex it before its contents are taken
+    size_t slot = index_.erase(name, files_);
+    if (slot == NameIndex::NOT_FOUND) {
+        return false;
     }
-    return false;
+    // move out of this folder (erasing it here) and into the destination
+    destination.appendFile(takeSlot(slot));
+    return true;
 }
 
 /**
@@ -169,8 +389,8 @@ bool Folder::moveFileTo(const std::string& name, Folder& destination) {
  * If there is already an object with the same name in the destination folder, 
  *    or the object with the specified name does not exist, do nothing.                                                                                                                                                                                                                                                       
  * Otherwise, if there exists a file with the given name from the source folder, 
- *    use the copy constructor or assignment operations to create a deep copy of the 
- *    the file into the destination.
+ *    use the copy constructor or assignment operations to create a copy of the 
+ *    the file into the destination (which shares the contents until either file is modified).
  * 
  * @param name The name of the copied object, as a const string reference
  * @param destination The destination folder, as a reference to a Folder object
@@ -182,21 +402,266 @@ bool Folder::copyFileTo(const std::string& name, Folder& destination) {
         return true;
     }
     // check if the destination has a file of the same name
-    for(auto it = destination.files_.begin(); it != destination.files_.end(); ++it) {
-        if ((*it).getName() == name) {
-            // if dupe exists, don't move and return false
-            return false;
-        }
+    if (destination.index_.find(name, destination.files_) != NameIndex::NOT_FOUND) {
+        // if dupe exists, don't move and return false
+        return false;
     }
     // search for file by name and copy it to the destination
-    for(auto it = files_.begin(); it != files_.end(); ++it) {
-        if ((*it).getName() == name) {
-            // move
-            File* copy = new File((*it));
-            destination.files_.push_back(std::move(*copy));
-            delete copy;    // after moving, copy should be in a state valid to delete
+    size_t slot = index_.find(name, files_);
+    if (slot == NameIndex::NOT_FOUND) {
+        return false;
+    }
+    // copying shares the contents and icon buffers, so this is O(1) regardless of file size
+    destination.appendFile(File(files_[slot]));
+    return true;
+}
+
+/**
+ * @brief Adds a batch of files, as if addFile were called on each in order, reserving space once
+ * 
+ * @param new_files The files to be added. Each accepted file is moved from.
+ * @return One entry per file: true if it was added, false if its name was empty or already taken (including earlier in the batch)
+ */
+std::vector<bool> Folder::addFiles(std::vector<File>& new_files) {
+    std::vector<bool> added(new_files.size(), false);
+    reserveFor(new_files.size());
+
+    for (size_t i = 0; i < new_files.size(); i++) {
+        std::string_view name = new_files[i].getNameView();
+        // the index already holds the files accepted earlier in this batch, so one lookup catches both kinds of duplicate
+        if (name.empty() || index_.find(name, files_) != NameIndex::NOT_FOUND) {
+            continue;
+        }
+        appendFile(std::move(new_files[i]));
+        added[i] = true;
+    }
+    return added;
+}
+
+/**
+ * @brief Deletes a batch of files by name, compacting files_ in a single pass
+ * 
+ * @param names The filenames to be deleted
+ * @return One entry per name: true if the file was found & deleted
+ */
+std::vector<bool> Folder::removeFiles(const std::vector<std::string>& names) {
+    std::vector<bool> removed(names.size(), false);
+    std::vector<size_t> slots;
+    slots.reserve(names.size());
+
+    for (size_t i = 0; i < names.size(); i++) {
+        // erasing the index entry right away makes a repeated name fail like a second removeFile would
+        size_t slot = index_.erase(names[i], files_);
+        if (slot != NameIndex::NOT_FOUND) {
+            slots.push_back(slot);
+            removed[i] = true;
+        }
+    }
+    extractSlots(slots, nullptr);
+    return removed;
+}
+
+/**
+ * @brief Moves a batch of files to the destination folder, with the same per-file rules as moveFileTo
+ * The destination is checked for duplicates once per name and grown once; this folder is compacted in a single pass.
+ * 
+ * @param names The filenames to be moved
+ * @param destination The target folder
+ * @return One entry per name: true if the file was moved successfully
+ */
+std::vector<bool> Folder::moveFilesTo(const std::vector<std::string>& names, Folder& destination) {
+    // if source and destination are the same, every move is considered successful
+    if (this == &destination) {
+        return std::vector<bool>(names.size(), true);
+    }
+    std::vector<bool> moved(names.size(), false);
+    std::vector<size_t> slots;
+    slots.reserve(names.size());
+
+    for (size_t i = 0; i < names.size(); i++) {
+        if (destination.index_.find(names[i], destination.files_) != NameIndex::NOT_FOUND) {
+            continue;
+        }
+        size_t slot = index_.erase(names[i], files_);
+        if (slot != NameIndex::NOT_FOUND) {
+            slots.push_back(slot);
+            moved[i] = true;
+        }
+    }
+    destination.reserveFor(slots.size());
+    extractSlots(slots, &destination);
+    return moved;
+}
+
+/**
+ * @brief Copies a batch of files to the destination folder, with the same per-file rules as copyFileTo
+ * 
+ * @param names The filenames to be copied
+ * @param destination The target folder
+ * @return One entry per name: true if the file was copied successfully
+ */
+std::vector<bool> Folder::copyFilesTo(const std::vector<std::string>& names, Folder& destination) {
+    // if source and destination are the same, every copy is considered successful
+    if (this == &destination) {
+        return std::vector<bool>(names.size(), true);
+    }
+    std::vector<bool> copied(names.size(), false);
+    destination.reserveFor(names.size());
+
+    for (size_t i = 0; i < names.size(); i++) {
+        if (destination.index_.find(names[i], destination.files_) != NameIndex::NOT_FOUND) {
+            continue;
+        }
+        size_t slot = index_.find(names[i], files_);
+        if (slot != NameIndex::NOT_FOUND) {
+            destination.appendFile(File(files_[slot]));
+            copied[i] = true;
+        }
+    }
+    return copied;
+}
+
+/**
+ * @brief Returns the subfolders, sorted lexicographically by name
+ */
+std::vector<Folder*> Folder::sortedSubfolders() const {
+    std::vector<Folder*> sorted;
+    sorted.reserve(subfolders_.size());
+    for (const std::unique_ptr<Folder>& folder : subfolders_) {
+        sorted.push_back(folder.get());
+    }
+    std::sort(sorted.begin(), sorted.end(), [](Folder* lhs, Folder* rhs) { return lhs->name_ < rhs->name_; });
+    return sorted;
+}
+
+/**
+ * @brief Appends the listing of this folder and, recursively, its subfolders to out
+ * @param depth The directory layer of this folder (0 for the folder display() was called on)
+ */
+void Folder::render(std::string& out, size_t depth) {
+    if (sorted_ < order_.size() || vacant_ > 0) {
+        refreshOrder();
+    }
+
+    std::string indent(3 * depth, ' ');
+    out += (depth == 0) ? name_ + "\n" : indent + "(FOLDER) " + name_ + "\n";
+    indent += "   ";
+
+    // each subfolder renders into its own buffer so they can run concurrently, then they're joined in order
+    std::vector<Folder*> children = sortedSubfolders();
+    std::vector<std::string> listings(children.size());
+    visitInParallel(children, [&listings, depth](size_t i, Folder& child) { child.render(listings[i], depth + 1); });
+    for (const std::string& listing : listings) {
+        out += listing;
+    }
+
+    for (size_t slot : order_) {
+        out += indent;
+        out += files_[slot].getNameView();
+        out += '\n';
+    }
+}
+
+/**
+ * @brief Creates a new, empty subfolder within this folder
+ * 
+ * @param name A string with alphanumeric characters (see the constructor)
+ * @return A pointer to the new subfolder, or nullptr if a subfolder with the same name already exists
+ * @throw If the name is invalid an InvalidFormatException is thrown
+ */
+Folder* Folder::createFolder(const std::string& name) {
+    std::unique_ptr<Folder> folder = std::make_unique<Folder>(name);
+    // check against the validated name, since an empty name becomes "NewFolder"
+    if (getFolder(folder->name_) != nullptr) {
+        return nullptr;
+    }
+    subfolders_.push_back(std::move(folder));
+    return subfolders_.back().get();
+}
+
+/**
+ * @brief Finds the direct subfolder with the given name
+ * @return A pointer to the subfolder, or nullptr if there is none
+ */
+Folder* Folder::getFolder(const std::string& name) {
+    for (const std::unique_ptr<Folder>& folder : subfolders_) {
+        if (folder->name_ == name) {
+            return folder.get();
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Deletes the direct subfolder with the given name, along with everything inside it
+ * @return True if the subfolder was found & deleted. False otherwise.
+ */
+bool Folder::removeFolder(const std::string& name) {
+    for (auto it = subfolders_.begin(); it != subfolders_.end(); ++it) {
+        if ((*it)->name_ == name) {
+            subfolders_.erase(it);
             return true;
         }
     }
     return false;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Calculates the total size of all files within this folder and all of its subfolders, in parallel
+ */
+size_t Folder::getTotalSize() const {
+    // a sum doesn't depend on order, so the subfolders are visited as stored rather than sorted by name
+    std::vector<size_t> sizes(subfolders_.size());
+    visitInParallel(subfolders_, [&sizes](size_t i, Folder& child) { sizes[i] = child.getTotalSize(); });
+
+    size_t total = getSize();
+    for (size_t size : sizes) {
+        total += size;
+    }
+    return total;
+}
+
+/**
+ * @brief Counts the files within this folder and all of its subfolders, in parallel
+ */
+size_t Folder::getTotalFileCount() const {
+    // a sum doesn't depend on order, so the subfolders are visited as stored rather than sorted by name
+    std::vector<size_t> counts(subfolders_.size());
+    visitInParallel(subfolders_, [&counts](size_t i, Folder& child) { counts[i] = child.getTotalFileCount(); });
+
+    size_t total = files_.size();
+    for (size_t count : counts) {
+        total += count;
+    }
+    return total;
+}
+
+/**
+ * @brief Searches this folder and all of its subfolders for files with the given name, in parallel
+ * 
+ * @param name The filename to look for
+ * @return The paths (eg. "root/sub/name.txt") of every match, ordered as display() would list them
+ */
+std::vector<std::string> Folder::search(const std::string& name) const {
+    std::vector<std::string> matches;
+    search(name, name_, matches);
+    return matches;
+}
+
+/**
+ * @brief Appends the path of every file called name within this subtree to out
+ * @param path The path of this folder, including its own name
+ */
+void Folder::search(const std::string& name, const std::string& path, std::vector<std::string>& out) const {
+    std::vector<Folder*> children = sortedSubfolders();
+    std::vector<std::vector<std::string>> found(children.size());
+    visitInParallel(children, [&](size_t i, Folder& child) { child.search(name, path + "/" + child.name_, found[i]); });
+
+    // subfolders are listed before files, so their matches come first
+    for (std::vector<std::string>& matches : found) {
+        std::move(matches.begin(), matches.end(), std::back_inserter(out));
+    }
+    if (index_.find(name, files_) != NameIndex::NOT_FOUND) {
+        out.push_back(path + "/" + name);
+    }
+}
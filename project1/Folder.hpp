@@ -2,15 +2,124 @@
 
 #include "File.hpp"
 #include "InvalidFormatException.hpp"
+#include "NameIndex.hpp"
+#include "ThreadPool.hpp"
 #include <algorithm>
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
 #include <vector>
 #include <iostream>
 #include <iterator>
 
+/**
+ * @brief Running aggregates over the files of a Folder, kept up to date on every mutation
+ */
+struct FolderStats {
+   static const size_t BUCKETS = 65;
+
+   size_t total_bytes_;   // Sum of the sizes of all files
+   size_t file_count_;    // Number of files
+   size_t min_size_;      // Size of the smallest file, or 0 if there are none
+   size_t max_size_;      // Size of the largest file, or 0 if there are none
+
+   // histogram_[b] counts the files whose size needs exactly b bits (ie. [2^(b-1), 2^b) bytes; bucket 0 holds empty files)
+   std::array<size_t, BUCKETS> histogram_;
+};
+
 class Folder {
    private:
       std::string name_;
       std::vector<File> files_;
+      NameIndex index_;             // Maps each filename to its slot in files_
+      std::vector<size_t> order_;   // The slots of files_ by name: sorted up to sorted_, appended since the last display() after it
+      std::vector<size_t> rank_;    // rank_[slot] is the position of slot within order_
+      size_t sorted_;               // Length of the sorted prefix of order_
+      size_t vacant_;               // Number of order_ entries left VACANT by removals
+
+      static const size_t VACANT = SIZE_MAX;
+
+      FolderStats stats_;
+      std::map<size_t, size_t> size_counts_;   // Number of files of each size, so min/max survive removals
+
+      /**
+       * @brief Adds a file of the given size to stats_
+       */
+      void recordSize(size_t size);
+
+      /**
+       * @brief Removes a file of the given size from stats_
+       */
+      void forgetSize(size_t size);
+
+      /**
+       * @brief Drops the VACANT entries of order_ and merges the unsorted tail into the sorted prefix
+       * @post order_ is fully sorted, holds exactly one entry per file, and rank_ matches it
+       */
+      void refreshOrder();
+
+      /**
+       * @brief Appends a file, recording its name in the name index and the file in the sorted view
+       * @pre No file with the same name exists within files_
+       */
+      void appendFile(File&& file);
+
+      /**
+       * @brief Moves the file out of the given slot and fills the slot with the last file (ie. swap-erase)
+       * @pre The index entry of the file at slot has already been erased
+       * @return The file previously stored at slot
+       */
+      File takeSlot(size_t slot);
+
+      // Batches taking fewer than 1 / COMPACT_RATIO of the files are swap-erased one at a time instead of compacted
+      static const size_t COMPACT_RATIO = 8;
+
+      /**
+       * @brief Makes room for extra more files without reallocating files_ or its bookkeeping
+       */
+      void reserveFor(size_t extra);
+
+      /**
+       * @brief Removes the files at the given slots in one pass, optionally moving them into destination
+       * @pre The index entries of the files at slots have already been erased, and no slot is listed twice
+       * @param slots The slots to remove (reordered by the call)
+       * @param destination The folder the removed files are appended to, or nullptr to delete them
+       */
+      void extractSlots(std::vector<size_t>& slots, Folder* destination);
+
+      std::vector<std::unique_ptr<Folder>> subfolders_;
+
+      // Subfolders directly holding fewer files than this (and no subfolders of their own) are not worth a task
+      static const size_t PARALLEL_CUTOFF = 4096;
+
+      /**
+       * @brief Returns the subfolders, sorted lexicographically by name
+       */
+      std::vector<Folder*> sortedSubfolders() const;
+
+      /**
+       * @brief Calls visit(i, *folders[i]) for every folder, spawning the non-trivial ones onto the shared ThreadPool
+       * @param folders A vector of Folder* (eg. sortedSubfolders(), when the order of results matters) or subfolders_ itself
+       * @note visit must be safe to call concurrently for different indices
+       */
+      template <typename Folders, typename Visit>
+      static void visitInParallel(const Folders& folders, Visit visit);
+
+      /**
+       * @brief Appends the listing of this folder and, recursively, its subfolders to out
+       * The folder display() was called on is printed by name alone, as it always has been; each subfolder is listed,
+       *    before the files, as "(FOLDER) <NAME>" followed by its own contents one layer deeper.
+       *    Subfolders are rendered in parallel, but the output order is fixed.
+       * @param depth The directory layer of this folder (0 for the folder display() was called on)
+       */
+      void render(std::string& out, size_t depth);
+
+      /**
+       * @brief Appends the path of every file called name within this subtree to out
+       * @param path The path of this folder, including its own name
+       */
+      void search(const std::string& name, const std::string& path, std::vector<std::string>& out) const;
 
    public:
       /**
@@ -54,10 +163,39 @@ class Folder {
       // =========================== YOUR CODE HERE ===========================
 
       /**
-      * @brief Iterate through the files vector, calculating the total size of all child files
+       * @brief Copy Constructor: Deep copies the folder, its files and, recursively, its subfolders
+       * @note The copied files share their contents with the originals until either side writes (see File's copy constructor)
+       */
+      Folder(const Folder& rhs);
+
+      /**
+       * @brief Copy Assignment: Replaces this folder's files and subfolders with deep copies of rhs's
+       */
+      Folder& operator=(const Folder& rhs);
+
+      Folder(Folder&& rhs) = default;
+      Folder& operator=(Folder&& rhs) = default;
+      ~Folder() = default;
+
+      /**
+      * @brief Returns the total size of all child files, maintained as files are added, removed or changed
       * @return size_t The total size of all child files
       */
      size_t getSize() const;
+
+      /**
+       * @brief Returns the running aggregates (total bytes, file count, min/max size, size histogram) in constant time
+       */
+      const FolderStats& getStats() const;
+
+      /**
+       * @brief Replaces the contents of the file with the given name, keeping the folder statistics current
+       * 
+       * @param name The name of the file to be modified
+       * @param contents The new contents of the file
+       * @return True if the file was found and modified. False otherwise.
+       */
+      bool setFileContents(const std::string& name, const std::string& contents);
       
       /**
       * @brief Appends the given file to the files_ vector using move_semantics on the parameter File object, if a file with the same name does not exist within the files_ vector
@@ -72,7 +210,7 @@ class Folder {
       /**
        * @brief Searches for a file within the files_ vector to be deleted.
        * If a file object with a matching name is found, erase it from the vector in linear [O(N)] time or better.
-       * Order does not matter.
+       * Order does not matter: the last file is moved into the vacated slot, so removal is O(1) expected.
        * 
        * @param name A const reference to a string representing the filename to be deleted
        * @return True if the file was found & successfully deleted. 
@@ -98,12 +236,109 @@ class Folder {
          * If there is already an object with the same name in the destination folder, 
          *    or the object with the specified name does not exist, do nothing.                                                                                                                                                                                                                                                       
          * Otherwise, if there exists a file with the given name from the source folder, 
-         *    use the copy constructor or assignment operations to create a deep copy of the 
-         *    the file into the destination.
+         *    use the copy constructor or assignment operations to create a copy of the 
+         *    the file into the destination (which shares the contents until either file is modified).
          * 
          * @param name The name of the copied object, as a const string reference
          * @param destination The destination folder, as a reference to a Folder object
          * @return True if the file was copied successfully. False otherwise.
          */
         bool copyFileTo(const std::string& name, Folder& destination);
-};
\ No newline at end of file
+
+      /**
+       * @brief Adds a batch of files, as if addFile were called on each in order, reserving space once
+       * 
+       * @param new_files The files to be added. Each accepted file is moved from.
+       * @return One entry per file: true if it was added, false if its name was empty or already taken (including earlier in the batch)
+       */
+      std::vector<bool> addFiles(std::vector<File>& new_files);
+
+      /**
+       * @brief Deletes a batch of files by name, compacting files_ in a single pass
+       * 
+       * @param names The filenames to be deleted
+       * @return One entry per name: true if the file was found & deleted
+       */
+      std::vector<bool> removeFiles(const std::vector<std::string>& names);
+
+      /**
+       * @brief Moves a batch of files to the destination folder, with the same per-file rules as moveFileTo
+       * The destination is checked for duplicates once per name and grown once; this folder is compacted in a single pass.
+       * 
+       * @param names The filenames to be moved
+       * @param destination The target folder
+       * @return One entry per name: true if the file was moved successfully
+       */
+      std::vector<bool> moveFilesTo(const std::vector<std::string>& names, Folder& destination);
+
+      /**
+       * @brief Copies a batch of files to the destination folder, with the same per-file rules as copyFileTo
+       * 
+       * @param names The filenames to be copied
+       * @param destination The target folder
+       * @return One entry per name: true if the file was copied successfully
+       */
+      std::vector<bool> copyFilesTo(const std::vector<std::string>& names, Folder& destination);
+
+      /**
+       * @brief Creates a new, empty subfolder within this folder
+       * 
+       * @param name A string with alphanumeric characters (see the constructor)
+       * @return A pointer to the new subfolder, or nullptr if a subfolder with the same name already exists
+       * @throw If the name is invalid an InvalidFormatException is thrown
+       */
+      Folder* createFolder(const std::string& name);
+
+      /**
+       * @brief Finds the direct subfolder with the given name
+       * @return A pointer to the subfolder, or nullptr if there is none
+       */
+      Folder* getFolder(const std::string& name);
+
+      /**
+       * @brief Deletes the direct subfolder with the given name, along with everything inside it
+       * @return True if the subfolder was found & deleted. False otherwise.
+       */
+      bool removeFolder(const std::string& name);
+
+      /**
+       * @brief Calculates the total size of all files within this folder and all of its subfolders, in parallel
+       */
+      size_t getTotalSize() const;
+
+      /**
+       * @brief Counts the files within this folder and all of its subfolders, in parallel
+       */
+      size_t getTotalFileCount() const;
+
+      /**
+       * @brief Searches this folder and all of its subfolders for files with the given name, in parallel
+       * 
+       * @param name The filename to look for
+       * @return The paths (eg. "root/sub/name.txt") of every match, ordered as display() would list them
+       */
+      std::vector<std::string> search(const std::string& name) const;
+};
+
+/**
+ * @brief Calls visit(i, *folders[i]) for every folder, spawning the non-trivial ones onto the shared ThreadPool
+ * @param folders A vector of Folder* (eg. sortedSubfolders(), when the order of results matters) or subfolders_ itself
+ * @note visit must be safe to call concurrently for different indices
+ */
+template <typename Folders, typename Visit>
+void Folder::visitInParallel(const Folders& folders, Visit visit) {
+   if (folders.empty()) { return; }
+
+   TaskGroup group;
+   for (size_t i = 0; i < folders.size(); i++) {
+      Folder* folder = &*folders[i];
+      // the last folder, and ones too small to repay spawning a task, are visited by this thread
+      bool worth_task = !folder->subfolders_.empty() || folder->files_.size() >= PARALLEL_CUTOFF;
+      if (i + 1 < folders.size() && worth_task) {
+         group.run([&visit, folder, i] { visit(i, *folder); });
+      } else {
+         visit(i, *folder);
+      }
+   }
+   group.wait();
+}
\ No newline at end of file
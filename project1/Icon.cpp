@@ -0,0 +1,181 @@
+#include "Icon.hpp"
+#include <cstring>
+
+/**
+ * @brief Compares the bitmaps of two pool entries
+ */
+bool Icon::EntryEqual::operator()(const Entry* lhs, const Entry* rhs) const {
+    return lhs->hash_ == rhs->hash_ && std::memcmp(lhs->pixels_, rhs->pixels_, DIM) == 0;
+}
+
+/**
+ * @brief Returns the pool of all interned bitmaps
+ */
+Icon::Pool& Icon::pool() {
+    static Pool interned;
+    return interned;
+}
+
+/**
+ * @brief Returns the lock guarding the pool, and each entry's count as it reaches zero
+ */
+std::mutex& Icon::poolMutex() {
+    static std::mutex lock;
+    return lock;
+}
+
+/**
+ * @brief Hashes a bitmap, a 64-bit word at a time
+ */
+size_t Icon::hash(const uint8_t* pixels) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull;
+    for (size_t offset = 0; offset < DIM; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, pixels + offset, sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    return static_cast<size_t>(hash);
+}
+
+/**
+ * @brief Points this handle at the pooled copy of the given bitmap, adding it to the pool if necessary
+ */
+void Icon::intern(const uint8_t* pixels) {
+    // probe with a stack entry so that sharing an existing bitmap allocates nothing
+    Entry probe;
+    std::memcpy(probe.pixels_, pixels, DIM);
+    probe.hash_ = hash(pixels);
+    probe.references_ = 1;
+
+    std::lock_guard<std::mutex> guard(poolMutex());
+    auto found = pool().find(&probe);
+    if (found != pool().end()) {
+        entry_ = *found;
+        entry_->references_++;
+    } else {
+        entry_ = new Entry;
+        std::memcpy(entry_->pixels_, pixels, DIM);
+        entry_->hash_ = probe.hash_;
+        entry_->references_ = 1;
+        pool().insert(entry_);
+    }
+}
+
+/**
+ * @brief Drops this handle's reference, removing the bitmap from the pool if it was the last one
+ */
+void Icon::release() {
+    if (!entry_) {
+        return;
+    }
+    // drop a reference without the lock while others remain. The last one is dropped under the lock, so intern()
+    //    can never find an entry that is about to be deleted.
+    size_t references = entry_->references_.load();
+    while (references > 1 && !entry_->references_.compare_exchange_weak(references, references - 1)) {}
+    if (references <= 1) {
+        std::lock_guard<std::mutex> guard(poolMutex());
+        if (--entry_->references_ == 0) {
+            pool().erase(entry_);
+            delete entry_;
+        }
+    }
+    entry_ = nullptr;
+}
+
+/**
+ * @brief Constructs an empty handle (ie. no icon)
+ */
+Icon::Icon() : entry_{nullptr} {}
+
+/**
+ * @brief Constructs a handle to the given bitmap
+ * @param pixels A length DIM array of pixels, which is copied into the pool if not already present
+ */
+Icon::Icon(const uint8_t* pixels) : entry_{nullptr} {
+    if (pixels) {
+        intern(pixels);
+    }
+}
+
+/**
+ * @brief Constructs a handle from a bitmap stored one pixel per int, as File's constructor accepts it
+ * @param pixels A length DIM array of values in [0, 255], or nullptr for no icon. Each value is truncated to 8 bits.
+ */
+Icon Icon::fromInts(const int* pixels) {
+    if (!pixels) {
+        return Icon();
+    }
+    uint8_t narrowed[DIM];
+    for (size_t i = 0; i < DIM; i++) {
+        narrowed[i] = static_cast<uint8_t>(pixels[i]);
+    }
+    return Icon(narrowed);
+}
+
+Icon::Icon(const Icon& rhs) : entry_{rhs.entry_} {
+    if (entry_) {
+        entry_->references_++;
+    }
+}
+
+Icon& Icon::operator=(const Icon& rhs) {
+    // take the new reference first, so self-assignment never drops the count to zero
+    if (rhs.entry_) {
+        rhs.entry_->references_++;
+    }
+    release();
+    entry_ = rhs.entry_;
+    return *this;
+}
+
+Icon::Icon(Icon&& rhs) noexcept : entry_{rhs.entry_} {
+    rhs.entry_ = nullptr;
+}
+
+Icon& Icon::operator=(Icon&& rhs) noexcept {
+    if (this != &rhs) {
+        release();
+        entry_ = rhs.entry_;
+        rhs.entry_ = nullptr;
+    }
+    return *this;
+}
+
+Icon::~Icon() {
+    release();
+}
+
+/**
+ * @brief Returns the interned pixels (read-only, as they are shared), or nullptr if there is no icon
+ */
+const uint8_t* Icon::pixels() const {
+    return entry_ ? entry_->pixels_ : nullptr;
+}
+
+/**
+ * @brief Returns true if this handle holds no icon
+ */
+bool Icon::empty() const {
+    return entry_ == nullptr;
+}
+
+/**
+ * @brief Two handles are equal exactly when they hold identical bitmaps (or both hold none)
+ */
+bool Icon::operator==(const Icon& rhs) const {
+    // interning guarantees one entry per distinct bitmap
+    return entry_ == rhs.entry_;
+}
+
+bool Icon::operator!=(const Icon& rhs) const {
+    return entry_ != rhs.entry_;
+}
+
+/**
+ * @brief Returns the number of distinct bitmaps currently interned
+ */
+size_t Icon::poolSize() {
+    std::lock_guard<std::mutex> guard(poolMutex());
+    return pool().size();
+}
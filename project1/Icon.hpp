@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+
+/**
+ * @brief A handle to an interned 16 x 16 bitmap of unsigned 8-bit pixels.
+ * Identical bitmaps are stored once in a process-wide pool; handles to them are reference counted,
+ *    so copying an Icon is a counter bump and comparing two Icons is a pointer comparison.
+ * A bitmap leaves the pool when its last handle is destroyed.
+ * @note The pool and reference counts are shared by every File, so they are synchronized: handles to the same bitmap may
+ *    be copied and destroyed from different threads. A single handle is still not safe to modify from several threads.
+ *    Counts are atomic; the pool is locked only to intern a bitmap and to drop the last reference to one.
+ */
+class Icon {
+   public:
+      static const size_t DIM = 256; // Representing a 16 x 16 bitmap
+
+   private:
+      struct Entry {
+         uint8_t pixels_[DIM];
+         size_t hash_;
+         std::atomic<size_t> references_;
+      };
+
+      struct EntryHash {
+         size_t operator()(const Entry* entry) const { return entry->hash_; }
+      };
+
+      struct EntryEqual {
+         bool operator()(const Entry* lhs, const Entry* rhs) const;
+      };
+
+      using Pool = std::unordered_set<Entry*, EntryHash, EntryEqual>;
+
+      Entry* entry_;   // nullptr when there is no icon
+
+      /**
+       * @brief Returns the pool of all interned bitmaps
+       */
+      static Pool& pool();
+
+      /**
+       * @brief Returns the lock guarding the pool, and each entry's count as it reaches zero
+       */
+      static std::mutex& poolMutex();
+
+      /**
+       * @brief Hashes a bitmap, a 64-bit word at a time
+       */
+      static size_t hash(const uint8_t* pixels);
+
+      /**
+       * @brief Points this handle at the pooled copy of the given bitmap, adding it to the pool if necessary
+       */
+      void intern(const uint8_t* pixels);
+
+      /**
+       * @brief Drops this handle's reference, removing the bitmap from the pool if it was the last one
+       */
+      void release();
+
+   public:
+      /**
+       * @brief Constructs an empty handle (ie. no icon)
+       */
+      Icon();
+
+      /**
+       * @brief Constructs a handle to the given bitmap
+       * @param pixels A length DIM array of pixels, which is copied into the pool if not already present
+       */
+      explicit Icon(const uint8_t* pixels);
+
+      /**
+       * @brief Constructs a handle from a bitmap stored one pixel per int, as File's constructor accepts it
+       * @param pixels A length DIM array of values in [0, 255], or nullptr for no icon. Each value is truncated to 8 bits.
+       */
+      static Icon fromInts(const int* pixels);
+
+      Icon(const Icon& rhs);
+      Icon& operator=(const Icon& rhs);
+      Icon(Icon&& rhs) noexcept;
+      Icon& operator=(Icon&& rhs) noexcept;
+      ~Icon();
+
+      /**
+       * @brief Returns the interned pixels (read-only, as they are shared), or nullptr if there is no icon
+       */
+      const uint8_t* pixels() const;
+
+      /**
+       * @brief Returns true if this handle holds no icon
+       */
+      bool empty() const;
+
+      /**
+       * @brief Two handles are equal exactly when they hold identical bitmaps (or both hold none)
+       */
+      bool operator==(const Icon& rhs) const;
+      bool operator!=(const Icon& rhs) const;
+
+      /**
+       * @brief Returns the number of distinct bitmaps currently interned
+       */
+      static size_t poolSize();
+};
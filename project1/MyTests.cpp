@@ -1,5 +1,50 @@
 #include "File.hpp"
 #include "Folder.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+// Counts every heap allocation made by the program, so tests can check that a code path makes none
+static std::atomic<size_t> allocations{0};
+
+// kept out of line so the compiler pairs the malloc/free below with each other, not with new/delete
+__attribute__((noinline)) void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+
+// the nothrow forms (used by std::inplace_merge's temporary buffer) must come from the same malloc that delete frees into
+__attribute__((noinline)) void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+__attribute__((noinline)) void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+// Counts every heap deallocation, so tests can check when an array handed to a File is freed
+static std::atomic<size_t> deallocations{0};
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { if (p) { deallocations++; } std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { if (p) { deallocations++; } std::free(p); }
+// the array forms are replaced too, rather than relying on the library forwarding them to the scalar ones
+__attribute__((noinline)) void operator delete[](void* p) noexcept { if (p) { deallocations++; } std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept { if (p) { deallocations++; } std::free(p); }
 
 int main() {
     // // others
@@ -105,4 +150,355 @@ int main() {
     else {
         std::cout << "fail";
     }
-}
\ No newline at end of file
+
+    // running statistics follow adds, moves, copies and content changes
+    Folder stats("stats");
+    File small("small.txt", "1");
+    File large("large.txt", std::string(1000, 'x'));
+    stats.addFile(small);
+    stats.addFile(large);
+    stats.setFileContents("small.txt", "12345");
+    stats.copyFileTo("large.txt", folder2);
+    stats.moveFileTo("large.txt", folder1);
+    const FolderStats& s = stats.getStats();
+    bool stats_ok = stats.getSize() == 5 && s.file_count_ == 1 && s.min_size_ == 5 && s.max_size_ == 5 && s.histogram_[3] == 1 && s.histogram_[10] == 0;
+    stats_ok = stats_ok && folder1.getStats().max_size_ == 1000 && folder1.getSize() == 1016;
+    std::cout << (stats_ok ? "passed" : "failed") << " folder stats" << std::endl;
+
+    // copies share contents and icon until one side writes
+    File original("shared.txt", std::string(1 << 20, 'x'), new int[256]());
+    File copy(original);
+    bool cow_ok = copy.getIcon() == original.getIcon() && copy.getSize() == original.getSize();
+    copy.setContents("changed");
+    cow_ok = cow_ok && original.getSize() == (1 << 20) && copy.getContents() == "changed";
+    std::cout << (cow_ok ? "passed" : "failed") << " copy-on-write" << std::endl;
+
+    // the icon is owned by the File and shared between copies: getIcon is read-only, and setIcon on a copy replaces only its own
+    {
+        static_assert(std::is_const<std::remove_pointer_t<decltype(original.getIcon())>>::value, "getIcon must not allow writes to a shared icon");
+        File sharer(original);
+        int* replacement = new int[256]();
+        replacement[0] = 9;
+        sharer.setIcon(replacement);
+        bool owned_ok = sharer.getIcon() != original.getIcon() && sharer.getIcon()[0] == 9 && original.getIcon()[0] == 0;
+        sharer.setIcon(nullptr);
+        owned_ok = owned_ok && sharer.getIcon() == nullptr && original.getIcon() != nullptr;
+        std::cout << (owned_ok ? "passed" : "failed") << " icon ownership" << std::endl;
+    }
+
+    // identical icons are interned once, as 8-bit pixels
+    {
+        size_t pooled = Icon::poolSize();
+        int* first = new int[256]();
+        int* second = new int[256]();
+        first[0] = second[0] = 200;
+        File a("a.png", "", first);
+        File b("b.png", "", second);
+        bool icon_ok = a.getIcon() == b.getIcon() && a.getIcon()[0] == 200 && Icon::poolSize() == pooled + 1;
+        std::cout << (icon_ok ? "passed" : "failed") << " icon interning" << std::endl;
+
+        // the int array passed to setIcon is freed during the call, so the caller must not use it afterwards;
+        //    getIcon returns the pooled 8-bit copy instead, with each value truncated to 8 bits
+        static_assert(std::is_same<decltype(a.getIcon()), const uint8_t*>::value, "getIcon returns interned 8-bit pixels");
+        int* handed = new int[256]();
+        handed[0] = 200;
+        handed[1] = 300;
+        File c("c.png");
+        size_t allocated_before = allocations, freed_before = deallocations;
+        c.setIcon(handed);
+        size_t freed = deallocations - freed_before;
+        bool handed_ok = freed >= 1 && c.getIcon()[0] == 200 && c.getIcon()[1] == 300 % 256 && Icon::poolSize() == pooled + 2;
+        c.setIcon(nullptr);
+        allocated_before = allocations;
+        freed_before = deallocations;
+        int* same = new int[256]();
+        same[0] = 200;
+        size_t allocated = allocations - allocated_before;
+        b.setIcon(same);
+        // interning into an existing bitmap allocates nothing; the only thing freed is the caller's array
+        handed_ok = handed_ok && allocations - allocated_before == allocated && deallocations - freed_before == 1 && b.getIcon() == a.getIcon()
+            && Icon::poolSize() == pooled + 1;
+        std::cout << (handed_ok ? "passed" : "failed") << " icon arrays freed on hand-over" << std::endl;
+
+        // different Files sharing the icon are copied and destroyed on several threads at once
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&a, &b, t] {
+                for (int i = 0; i < 20000; i++) {
+                    File copied(t % 2 ? a : b);
+                    int* again = new int[256]();
+                    again[0] = 200;
+                    File interned("c.png", "", again);
+                }
+            });
+        }
+        for (std::thread& thread : threads) { thread.join(); }
+        bool shared_ok = Icon::poolSize() == pooled + 1 && a.getIcon() == b.getIcon() && a.getIcon()[0] == 200;
+        std::cout << (shared_ok ? "passed" : "failed") << " concurrent icon sharing" << std::endl;
+    }
+
+    // nested folders: recursive totals, search and display
+    Folder root("root");
+    Folder* docs = root.createFolder("docs");
+    Folder* drafts = docs->createFolder("drafts");
+    File readme("readme.txt", "123");
+    File notes("notes.txt", "1234567");
+    File draft("readme.txt", "12");
+    root.addFile(readme);
+    docs->addFile(notes);
+    drafts->addFile(draft);
+    std::vector<std::string> found = root.search("readme.txt");
+    bool tree_ok = root.getTotalSize() == 12 && root.getTotalFileCount() == 3 && root.createFolder("docs") == nullptr;
+    tree_ok = tree_ok && found.size() == 2 && found[0] == "root/docs/drafts/readme.txt" && found[1] == "root/readme.txt";
+    std::cout << (tree_ok ? "passed" : "failed") << " nested folders" << std::endl;
+    root.display();
+
+    // copying a folder deep copies its subfolders, so changes to the copy leave the original alone
+    Folder backup(root);
+    backup.getFolder("docs")->removeFolder("drafts");
+    backup.removeFile("readme.txt");
+    Folder assigned("assigned");
+    assigned = root;
+    assigned = assigned;
+    bool copy_ok = backup.getTotalFileCount() == 1 && root.getTotalFileCount() == 3 && root.getFolder("docs")->getFolder("drafts") != nullptr
+        && assigned.getName() == "root" && assigned.getTotalSize() == 12 && assigned.getFolder("docs") != root.getFolder("docs");
+    std::cout << (copy_ok ? "passed" : "failed") << " folder copies" << std::endl;
+
+    // subfolders past PARALLEL_CUTOFF are visited as pool tasks; the totals must match a serial walk of the same tree
+    {
+        Folder wide("wide");
+        size_t serial_size = 0, serial_count = 0;
+        std::vector<std::string> serial_found;
+        std::vector<Folder*> level = {&wide};
+        for (int depth = 0; depth < 2; depth++) {
+            std::vector<Folder*> next;
+            for (Folder* parent : level) {
+                for (int child = 0; child < 3; child++) {
+                    next.push_back(parent->createFolder("d" + std::to_string(depth) + "c" + std::to_string(child)));
+                }
+            }
+            level = next;
+        }
+        // level holds the 9 leaves; fill them, and every middle folder, with a few thousand files each
+        std::vector<Folder*> filled = level;
+        for (Folder* middle : {wide.getFolder("d0c0"), wide.getFolder("d0c1"), wide.getFolder("d0c2")}) { filled.push_back(middle); }
+        for (size_t f = 0; f < filled.size(); f++) {
+            std::vector<File> batch;
+            for (size_t i = 0; i < 5000 + f; i++) {
+                batch.emplace_back("f" + std::to_string(i) + ".txt", std::string(i % 7, 'x'));
+                serial_size += i % 7;
+            }
+            batch.emplace_back("shared.txt", "1");
+            serial_size += 1;
+            serial_count += batch.size();
+            filled[f]->addFiles(batch);
+        }
+        // search lists subfolders first, in name order, then the folder's own files
+        for (int middle = 0; middle < 3; middle++) {
+            std::string path = "wide/d0c" + std::to_string(middle);
+            for (int leaf = 0; leaf < 3; leaf++) {
+                serial_found.push_back(path + "/d1c" + std::to_string(leaf) + "/shared.txt");
+            }
+            serial_found.push_back(path + "/shared.txt");
+        }
+        bool parallel_ok = wide.getTotalSize() == serial_size && wide.getTotalFileCount() == serial_count
+            && wide.search("shared.txt") == serial_found && wide.search("f5008.txt").size() == 3;
+        std::cout << (parallel_ok ? "passed" : "failed") << " parallel traversal" << std::endl;
+    }
+
+    // ingest scaling: with the name index, time per file should stay flat as the folder grows
+    for (size_t count : {250000, 500000, 1000000}) {
+        Folder big("big");
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            File file("f" + std::to_string(i) + ".txt");
+            big.addFile(file);
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "ingest " << count << " files: " << elapsed << " ms (" << elapsed * 1e6 / count << " ns/file)" << std::endl;
+
+        // every file should still be reachable after swap-erasing half of them
+        for (size_t i = 0; i < count; i += 2) { big.removeFile("f" + std::to_string(i) + ".txt"); }
+        bool ok = true;
+        for (size_t i = 0; i < count; i++) {
+            File probe("f" + std::to_string(i) + ".txt");
+            // a duplicate add fails exactly when the file is still present
+            ok = ok && (big.addFile(probe) == (i % 2 == 0));
+        }
+        std::cout << (ok ? "passed" : "failed") << " index consistency" << std::endl;
+    }
+
+    // bulk reorganization: moving 50k of 200k files one call at a time vs. as one batch
+    for (bool batched : {false, true}) {
+        Folder source("source");
+        Folder target("target");
+        std::vector<File> incoming;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < 200000; i++) {
+            incoming.emplace_back("f" + std::to_string(i) + ".txt", "1");
+            if (i % 4 == 0) { names.push_back("f" + std::to_string(i) + ".txt"); }
+        }
+        source.addFiles(incoming);
+
+        auto start = std::chrono::steady_clock::now();
+        if (batched) {
+            source.moveFilesTo(names, target);
+        } else {
+            for (const std::string& name : names) { source.moveFileTo(name, target); }
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        bool moved_ok = source.getTotalFileCount() == 150000 && target.getSize() == 50000;
+        std::cout << (batched ? "moveFilesTo: " : "moveFileTo x50000: ") << elapsed << " ms, " << (moved_ok ? "passed" : "failed") << std::endl;
+    }
+
+    // display() stays sorted through interleaved adds, removes and moves, including the early compaction once
+    //    removals leave more holes in the sorted view than there are files
+    {
+        Folder left("left");
+        Folder right("right");
+        std::set<std::string> in_left, in_right;
+        auto listing = [](Folder& folder, const std::set<std::string>& names) {
+            std::ostringstream shown;
+            std::streambuf* saved = std::cout.rdbuf(shown.rdbuf());
+            folder.display();
+            std::cout.rdbuf(saved);
+            std::string expected = folder.getName() + "\n";
+            for (const std::string& name : names) { expected += "   " + name + "\n"; }
+            return shown.str() == expected;
+        };
+        bool order_ok = true;
+        uint32_t seed = 12345;
+        auto draw = [&seed](uint32_t bound) { seed = seed * 1664525u + 1013904223u; return (seed >> 8) % bound; };
+        for (int round = 0; round < 6; round++) {
+            // a burst of adds, then a mix of everything with only occasional displays
+            for (int i = 0; i < 300; i++) {
+                std::string name = "n" + std::to_string(draw(1000)) + ".txt";
+                File file(name, "x");
+                if (left.addFile(file)) { in_left.insert(name); }
+            }
+            order_ok = order_ok && listing(left, in_left);
+            for (int i = 0; i < 400; i++) {
+                std::string name = "n" + std::to_string(draw(1000)) + ".txt";
+                switch (draw(4)) {
+                    case 0:
+                        if (left.moveFileTo(name, right)) { in_left.erase(name); in_right.insert(name); }
+                        break;
+                    case 1:
+                        if (right.moveFileTo(name, left)) { in_right.erase(name); in_left.insert(name); }
+                        break;
+                    case 2: {
+                        File file(name, "y");
+                        if (left.addFile(file)) { in_left.insert(name); }
+                        break;
+                    }
+                    default:
+                        if (left.removeFile(name)) { in_left.erase(name); }
+                }
+                if (draw(50) == 0) {
+                    order_ok = order_ok && listing(left, in_left) && listing(right, in_right);
+                }
+            }
+            // then take out most of left without displaying, so holes outnumber files and takeSlot compacts early
+            order_ok = order_ok && listing(left, in_left);
+            std::vector<std::string> doomed(in_left.begin(), in_left.end());
+            for (size_t i = 0; i < doomed.size(); i++) {
+                if (i % 5 == 4) { continue; }
+                if (i % 2 == 0) {
+                    order_ok = order_ok && left.removeFile(doomed[i]);
+                    in_left.erase(doomed[i]);
+                } else if (left.moveFileTo(doomed[i], right)) {
+                    in_left.erase(doomed[i]);
+                    in_right.insert(doomed[i]);
+                }
+                if (i % 7 == 0) {
+                    File file("late" + std::to_string(round) + "x" + std::to_string(i) + ".txt", "z");
+                    left.addFile(file);
+                    in_left.insert("late" + std::to_string(round) + "x" + std::to_string(i) + ".txt");
+                }
+            }
+            order_ok = order_ok && listing(left, in_left) && listing(right, in_right);
+        }
+        std::cout << (order_ok ? "passed" : "failed") << " sorted display" << std::endl;
+    }
+
+    // batch operations report a result per item, and both ways extractSlots removes files keep the folder consistent
+    {
+        Folder batch("batch");
+        File gone("gone.txt");
+        File taker(std::move(gone));
+        std::vector<File> incoming;
+        incoming.emplace_back("a.txt", "1");
+        incoming.push_back(std::move(gone));
+        incoming.emplace_back("b.txt", "22");
+        incoming.emplace_back("a.txt", "333");
+        bool batch_ok = batch.addFiles(incoming) == std::vector<bool>{true, false, true, false} && batch.getSize() == 3;
+        batch_ok = batch_ok && batch.removeFiles({"a.txt", "a.txt", "zz.txt"}) == std::vector<bool>{true, false, false};
+
+        Folder other("other");
+        File existing("b.txt", "other");
+        other.addFile(existing);
+        File c("c.txt", "4444");
+        batch.addFile(c);
+        batch_ok = batch_ok && batch.copyFilesTo({"b.txt", "c.txt", "zz.txt", "c.txt"}, other) == std::vector<bool>{false, true, false, false}
+            && other.getSize() == 9 && batch.getSize() == 6;
+
+        // 64 files: taking 2 is below 1 / COMPACT_RATIO, so they are swap-erased; taking 40 compacts in one sweep
+        std::vector<File> many;
+        for (int i = 0; i < 62; i++) { many.emplace_back("m" + std::to_string(i) + ".txt", std::string(i, 'x')); }
+        batch.addFiles(many);
+        auto present = [&batch](int i) { return batch.search("m" + std::to_string(i) + ".txt").size() == 1; };
+        batch_ok = batch_ok && batch.removeFiles({"m5.txt", "m60.txt"}) == std::vector<bool>{true, true} && !present(5) && !present(60)
+            && present(61) && present(0) && batch.getTotalFileCount() == 62;
+        std::vector<std::string> taken;
+        for (int i = 0; i < 62; i += 3) { taken.push_back("m" + std::to_string(i) + ".txt"); }
+        for (int i = 1; i < 62 && taken.size() < 40; i += 3) { taken.push_back("m" + std::to_string(i) + ".txt"); }
+        std::vector<bool> moved = batch.moveFilesTo(taken, other);
+        size_t moved_count = std::count(moved.begin(), moved.end(), true);
+        bool survivors_ok = true;
+        size_t survivor_bytes = 0;
+        for (int i = 0; i < 62; i++) {
+            bool was_taken = std::find(taken.begin(), taken.end(), "m" + std::to_string(i) + ".txt") != taken.end();
+            bool kept = i != 5 && i != 60 && !was_taken;
+            survivors_ok = survivors_ok && present(i) == kept && (other.search("m" + std::to_string(i) + ".txt").size() == 1) == (was_taken && i != 60);
+            survivor_bytes += kept ? i : 0;
+        }
+        // m60 was already removed, so its move fails; every other name moves
+        batch_ok = batch_ok && moved_count == taken.size() - 1 && !moved[std::find(taken.begin(), taken.end(), "m60.txt") - taken.begin()]
+            && survivors_ok && batch.getSize() == survivor_bytes + 6 && batch.getStats().file_count_ == 62 - moved_count;
+        std::cout << (batch_ok ? "passed" : "failed") << " batch results" << std::endl;
+    }
+
+    // name lookups and sorts by name make no heap allocations, even for names too long to be stored inline
+    {
+        Folder lookups("lookups");
+        std::vector<File> files;
+        for (int i = 0; i < 64; i++) {
+            files.emplace_back("averyverylongfilenamethatisnotstoredinline" + std::to_string(i) + ".txt");
+        }
+        std::vector<File> sorted = files;
+        File duplicate(files[7]);
+        lookups.addFiles(files);
+        std::string missing = "averyverylongfilenamethatisnotstoredinline99.txt";
+
+        size_t before = allocations;
+        std::sort(sorted.begin(), sorted.end());
+        bool looked_up = !lookups.addFile(duplicate) && !lookups.removeFile(missing) && !lookups.copyFileTo(missing, folder1)
+            && !lookups.moveFileTo(missing, folder1);
+        size_t made = allocations - before;
+        bool alloc_ok = made == 0 && looked_up && sorted.front().getNameView() == "averyverylongfilenamethatisnotstoredinline0.txt";
+        std::cout << (alloc_ok ? "passed" : "failed") << " zero-allocation lookups" << std::endl;
+    }
+
+    // short names are stored inline (only the contents buffer is allocated), long ones spill to the heap, and a moved-from File has an empty name
+    {
+        std::string short_name = "quarterlyreport2024";
+        size_t before = allocations;
+        File inline_name(short_name, "x");
+        size_t made = allocations - before;
+        File spilled("averyverylongfilenamethatisnotstoredinline", "x");
+        File taken(std::move(spilled));
+        bool names_ok = made == 1 && inline_name.getFileName().extension() == "txt" && inline_name.getFileName().base() == "quarterlyreport2024"
+            && taken.getName() == "averyverylongfilenamethatisnotstoredinline.txt" && spilled.getName().empty() && !folder1.addFile(spilled);
+        std::cout << (names_ok ? "passed" : "failed") << " inline file names" << std::endl;
+    }
+}
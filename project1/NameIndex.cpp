@@ -0,0 +1,164 @@
+#include "NameIndex.hpp"
+#include <algorithm>
+
+/**
+ * @brief Construct an empty NameIndex
+ */
+NameIndex::NameIndex() : table_{}, count_{0} {}
+
+/**
+ * @brief Returns the number of indexed names
+ */
+size_t NameIndex::size() const {
+    return count_;
+}
+
+/**
+ * @brief Finds the table position of the entry for the given name
+ * @return The table position, or NOT_FOUND if the name is not indexed
+ */
+size_t NameIndex::position(std::string_view name, size_t hash, const std::vector<File>& files) const {
+    if (table_.empty()) {
+        return NOT_FOUND;
+    }
+    size_t mask = table_.size() - 1;
+    // probe until we hit an empty entry; a run never wraps onto itself since the table is at most half full
+    for (size_t i = hash & mask; table_[i].slot_ != NOT_FOUND; i = (i + 1) & mask) {
+        // only compare the strings when the hashes agree
+        if (table_[i].hash_ == hash && files[table_[i].slot_].getNameView() == name) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+/**
+ * @brief Doubles the table (or allocates the initial one) and re-inserts all entries
+ */
+void NameIndex::grow() {
+    std::vector<Entry> old = std::move(table_);
+    table_.assign(old.empty() ? MIN_CAPACITY : old.size() * 2, Entry{0, NOT_FOUND});
+
+    size_t mask = table_.size() - 1;
+    for (const Entry& entry : old) {
+        if (entry.slot_ == NOT_FOUND) {
+            continue;
+        }
+        size_t i = entry.hash_ & mask;
+        while (table_[i].slot_ != NOT_FOUND) {
+            i = (i + 1) & mask;
+        }
+        table_[i] = entry;
+    }
+}
+
+/**
+ * @brief Ensures count entries fit without rehashing
+ */
+void NameIndex::reserve(size_t count) {
+    // keep the load factor at or below one half
+    while (table_.size() < count * 2) {
+        grow();
+    }
+}
+
+/**
+ * @brief Removes every entry, keeping the allocated table
+ */
+void NameIndex::clear() {
+    std::fill(table_.begin(), table_.end(), Entry{0, NOT_FOUND});
+    count_ = 0;
+}
+
+/**
+ * @brief Looks up the slot of the file with the given name
+ *
+ * @param name The filename to look up
+ * @param files The vector the slots refer to
+ * @return The slot within files, or NOT_FOUND if no file with that name is indexed
+ */
+size_t NameIndex::find(std::string_view name, const std::vector<File>& files) const {
+    size_t i = position(name, FileName::hashOf(name), files);
+    return i == NOT_FOUND ? NOT_FOUND : table_[i].slot_;
+}
+
+/**
+ * @brief Records that the file with the given name lives at slot
+ * @pre No file with the same name is currently indexed
+ */
+void NameIndex::insert(const FileName& name, size_t slot) {
+    reserve(count_ + 1);
+
+    // FileName caches the same hash that find() computes for a view, so it isn't recomputed here
+    size_t hash = name.hash();
+    size_t mask = table_.size() - 1;
+    size_t i = hash & mask;
+    while (table_[i].slot_ != NOT_FOUND) {
+        i = (i + 1) & mask;
+    }
+    table_[i] = Entry{hash, slot};
+    count_++;
+}
+
+/**
+ * @brief Removes the entry for the given name
+ *
+ * @param name The filename to remove
+ * @param files The vector the slots refer to
+ * @return The slot the removed entry referred to, or NOT_FOUND if the name was not indexed
+ */
+size_t NameIndex::erase(std::string_view name, const std::vector<File>& files) {
+    size_t hole = position(name, FileName::hashOf(name), files);
+    if (hole == NOT_FOUND) {
+        return NOT_FOUND;
+    }
+    size_t slot = table_[hole].slot_;
+
+    // backward-shift deletion: pull later entries of the probe run into the hole
+    // whenever the hole lies between their home position and their current position
+    size_t mask = table_.size() - 1;
+    for (size_t i = (hole + 1) & mask; table_[i].slot_ != NOT_FOUND; i = (i + 1) & mask) {
+        size_t home = table_[i].hash_ & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            table_[hole] = table_[i];
+            hole = i;
+        }
+    }
+    table_[hole] = Entry{0, NOT_FOUND};
+    count_--;
+    return slot;
+}
+
+/**
+ * @brief Updates the entry of the named file after it was moved from one slot to another (eg. swap-erase)
+ *
+ * @param name The name of the moved file
+ * @param from The slot the file used to occupy
+ * @param to The slot the file occupies now
+ */
+void NameIndex::relocate(const FileName& name, size_t from, size_t to) {
+    if (table_.empty()) {
+        return;
+    }
+    size_t hash = name.hash();
+    size_t mask = table_.size() - 1;
+    // slots are unique, so matching on the slot alone identifies the entry without a string compare
+    for (size_t i = hash & mask; table_[i].slot_ != NOT_FOUND; i = (i + 1) & mask) {
+        if (table_[i].slot_ == from) {
+            table_[i].slot_ = to;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Re-points every entry after files were compacted
+ * @param remap remap[old_slot] is the slot the file now occupies. Erased files need no valid mapping.
+ */
+void NameIndex::remap(const std::vector<size_t>& remap) {
+    for (Entry& entry : table_) {
+        if (entry.slot_ != NOT_FOUND) {
+            entry.slot_ = remap[entry.slot_];
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "File.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief An open-addressing hash table mapping file names to their slot within a Folder's files_ vector.
+ * The index does not store the names themselves; each entry keeps the name's hash and the slot it refers to,
+ *    and full comparisons are made against the File living in that slot.
+ * Uses linear probing with backward-shift deletion, so no tombstones accumulate under churn.
+ */
+class NameIndex {
+   private:
+      struct Entry {
+         size_t hash_;
+         size_t slot_;
+      };
+
+      static const size_t MIN_CAPACITY = 16;
+
+      std::vector<Entry> table_;
+      size_t count_;
+
+      /**
+       * @brief Finds the table position of the entry for the given name
+       * @return The table position, or NOT_FOUND if the name is not indexed
+       */
+      size_t position(std::string_view name, size_t hash, const std::vector<File>& files) const;
+
+      /**
+       * @brief Doubles the table (or allocates the initial one) and re-inserts all entries
+       */
+      void grow();
+
+   public:
+      static const size_t NOT_FOUND = SIZE_MAX;
+
+      /**
+       * @brief Construct an empty NameIndex
+       */
+      NameIndex();
+
+      /**
+       * @brief Looks up the slot of the file with the given name
+       *
+       * @param name The filename to look up
+       * @param files The vector the slots refer to
+       * @return The slot within files, or NOT_FOUND if no file with that name is indexed
+       */
+      size_t find(std::string_view name, const std::vector<File>& files) const;
+
+      /**
+       * @brief Records that the file with the given name lives at slot
+       * @pre No file with the same name is currently indexed
+       */
+      void insert(const FileName& name, size_t slot);
+
+      /**
+       * @brief Removes the entry for the given name
+       *
+       * @param name The filename to remove
+       * @param files The vector the slots refer to
+       * @return The slot the removed entry referred to, or NOT_FOUND if the name was not indexed
+       */
+      size_t erase(std::string_view name, const std::vector<File>& files);
+
+      /**
+       * @brief Updates the entry of the named file after it was moved from one slot to another (eg. swap-erase)
+       *
+       * @param name The name of the moved file
+       * @param from The slot the file used to occupy
+       * @param to The slot the file occupies now
+       */
+      void relocate(const FileName& name, size_t from, size_t to);
+
+      /**
+       * @brief Re-points every entry after files were compacted
+       * @param remap remap[old_slot] is the slot the file now occupies. Erased files need no valid mapping.
+       */
+      void remap(const std::vector<size_t>& remap);
+
+      /**
+       * @brief Ensures count entries fit without rehashing
+       */
+      void reserve(size_t count);
+
+      /**
+       * @brief Removes every entry, keeping the allocated table
+       */
+      void clear();
+
+      /**
+       * @brief Returns the number of indexed names
+       */
+      size_t size() const;
+};
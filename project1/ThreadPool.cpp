@@ -0,0 +1,184 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+thread_local ThreadPool* ThreadPool::current_pool_ = nullptr;
+thread_local size_t ThreadPool::current_queue_ = 0;
+
+/**
+ * @brief Starts a pool with the given number of workers
+ * @param threads The number of workers. If 0, one per hardware thread is started.
+ */
+ThreadPool::ThreadPool(size_t threads) : queues_{}, threads_{}, queued_{0}, next_queue_{0}, stopping_{false} {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    // only start the workers once every queue exists, since they steal from each other
+    for (size_t i = 0; i < threads; i++) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+/**
+ * @brief Finishes the queued tasks and joins all workers
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Wakes every thread sleeping in runUntil() or waiting for work, so each checks its condition again
+ */
+void ThreadPool::notifyWaiters() {
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_all();
+}
+
+/**
+ * @brief Returns the number of worker threads
+ */
+size_t ThreadPool::threadCount() const {
+    return threads_.size();
+}
+
+/**
+ * @brief Returns the process-wide pool, started on first use with one worker per hardware thread
+ */
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+/**
+ * @brief Queues a task. From a worker it goes onto that worker's own deque, otherwise the queues are used round-robin.
+ */
+void ThreadPool::submit(std::function<void()> task) {
+    size_t queue = (current_pool_ == this) ? current_queue_ : next_queue_++ % queues_.size();
+    {
+        // count the task under the same lock that publishes it, so a popBack or steal can never decrement queued_ first
+        std::lock_guard<std::mutex> lock(queues_[queue]->mutex_);
+        queues_[queue]->tasks_.push_back(std::move(task));
+        queued_++;
+    }
+
+    // taking the lock orders this wake-up after any worker's check of queued_, so it cannot be missed
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_one();
+}
+
+/**
+ * @brief Takes a task from the back of the given queue
+ * @return True if a task was taken
+ */
+bool ThreadPool::popBack(size_t queue, std::function<void()>& task) {
+    std::lock_guard<std::mutex> lock(queues_[queue]->mutex_);
+    if (queues_[queue]->tasks_.empty()) {
+        return false;
+    }
+    task = std::move(queues_[queue]->tasks_.back());
+    queues_[queue]->tasks_.pop_back();
+    queued_--;
+    return true;
+}
+
+/**
+ * @brief Takes a task from the front of any queue other than the given one
+ * @return True if a task was taken
+ */
+bool ThreadPool::steal(size_t thief, std::function<void()>& task) {
+    for (size_t offset = 1; offset <= queues_.size(); offset++) {
+        size_t victim = (thief + offset) % queues_.size();
+        std::lock_guard<std::mutex> lock(queues_[victim]->mutex_);
+        if (queues_[victim]->tasks_.empty()) {
+            continue;
+        }
+        task = std::move(queues_[victim]->tasks_.front());
+        queues_[victim]->tasks_.pop_front();
+        queued_--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Runs one queued task on the calling thread, if any is available.
+ *    Lets a thread that waits for tasks help execute them instead of blocking.
+ * @return True if a task was run
+ */
+bool ThreadPool::runPendingTask() {
+    std::function<void()> task;
+    if (current_pool_ == this) {
+        if (!popBack(current_queue_, task) && !steal(current_queue_, task)) {
+            return false;
+        }
+    } else if (!steal(next_queue_ % queues_.size(), task)) {
+        // a thread outside the pool has no queue of its own, so it can only steal
+        return false;
+    }
+    task();
+    return true;
+}
+
+/**
+ * @brief The routine run by each worker thread until the pool is destroyed
+ */
+void ThreadPool::workerLoop(size_t queue) {
+    current_pool_ = this;
+    current_queue_ = queue;
+
+    while (true) {
+        if (runPendingTask()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return queued_ > 0 || stopping_; });
+        if (stopping_ && queued_ == 0) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Construct an empty TaskGroup spawning onto the given pool
+ */
+TaskGroup::TaskGroup(ThreadPool& pool) : pool_{pool}, pending_{0} {}
+
+/**
+ * @brief Waits for any tasks still pending
+ */
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+/**
+ * @brief Spawns a task as part of this group
+ */
+void TaskGroup::run(std::function<void()> task) {
+    pending_++;
+    // the group may be destroyed as soon as pending_ reaches 0, so the wake-up goes through a reference to the pool
+    ThreadPool& pool = pool_;
+    pool_.submit([this, &pool, task = std::move(task)] {
+        task();
+        if (--pending_ == 0) {
+            // the group's waiter may be asleep in runUntil()
+            pool.notifyWaiters();
+        }
+    });
+}
+
+/**
+ * @brief Returns once every task of the group has finished, running queued tasks on the calling thread meanwhile
+ *    and sleeping while there are none, rather than spinning
+ */
+void TaskGroup::wait() {
+    pool_.runUntil([this] { return pending_ == 0; });
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed-size work-stealing thread pool.
+ * Every worker owns a deque: it pushes and pops its own tasks at the back (most recently spawned, still cache-warm),
+ *    while idle workers steal from the front of other workers' deques (oldest, usually the largest pieces of work).
+ * Tasks must not throw.
+ */
+class ThreadPool {
+   private:
+      struct WorkQueue {
+         std::mutex mutex_;
+         std::deque<std::function<void()>> tasks_;
+      };
+
+      std::vector<std::unique_ptr<WorkQueue>> queues_;
+      std::vector<std::thread> threads_;
+      std::atomic<size_t> queued_;       // Tasks pushed but not yet taken, across all queues
+      std::atomic<size_t> next_queue_;   // Round-robin target for tasks submitted from outside the pool
+      std::atomic<bool> stopping_;
+      std::mutex sleep_mutex_;
+      std::condition_variable wake_;
+
+      // The pool and queue index of the calling worker thread, if any
+      static thread_local ThreadPool* current_pool_;
+      static thread_local size_t current_queue_;
+
+      /**
+       * @brief Takes a task from the back of the given queue
+       * @return True if a task was taken
+       */
+      bool popBack(size_t queue, std::function<void()>& task);
+
+      /**
+       * @brief Takes a task from the front of any queue other than the given one
+       * @return True if a task was taken
+       */
+      bool steal(size_t thief, std::function<void()>& task);
+
+      /**
+       * @brief The routine run by each worker thread until the pool is destroyed
+       */
+      void workerLoop(size_t queue);
+
+   public:
+      /**
+       * @brief Starts a pool with the given number of workers
+       * @param threads The number of workers. If 0, one per hardware thread is started.
+       */
+      explicit ThreadPool(size_t threads = 0);
+
+      /**
+       * @brief Finishes the queued tasks and joins all workers
+       */
+      ~ThreadPool();
+
+      ThreadPool(const ThreadPool&) = delete;
+      ThreadPool& operator=(const ThreadPool&) = delete;
+
+      /**
+       * @brief Queues a task. From a worker it goes onto that worker's own deque, otherwise the queues are used round-robin.
+       */
+      void submit(std::function<void()> task);
+
+      /**
+       * @brief Runs one queued task on the calling thread, if any is available.
+       *    Lets a thread that waits for tasks help execute them instead of blocking.
+       * @return True if a task was run
+       */
+      bool runPendingTask();
+
+      /**
+       * @brief Runs queued tasks on the calling thread until done() holds, sleeping whenever there are none to run
+       * @note Whatever makes done() true must call notifyWaiters() afterwards, or a sleeping caller may not see it
+       */
+      template <typename Done>
+      void runUntil(Done done);
+
+      /**
+       * @brief Wakes every thread sleeping in runUntil() or waiting for work, so each checks its condition again
+       */
+      void notifyWaiters();
+
+      /**
+       * @brief Returns the number of worker threads
+       */
+      size_t threadCount() const;
+
+      /**
+       * @brief Returns the process-wide pool, started on first use with one worker per hardware thread
+       */
+      static ThreadPool& shared();
+};
+
+/**
+ * @brief A set of tasks spawned onto a ThreadPool that can be waited for together (fork-join)
+ */
+class TaskGroup {
+   private:
+      ThreadPool& pool_;
+      std::atomic<size_t> pending_;
+
+   public:
+      /**
+       * @brief Construct an empty TaskGroup spawning onto the given pool
+       */
+      explicit TaskGroup(ThreadPool& pool = ThreadPool::shared());
+
+      /**
+       * @brief Waits for any tasks still pending
+       */
+      ~TaskGroup();
+
+      /**
+       * @brief Spawns a task as part of this group
+       */
+      void run(std::function<void()> task);
+
+      /**
+       * @brief Returns once every task of the group has finished, running queued tasks on the calling thread meanwhile
+       *    and sleeping while there are none, rather than spinning
+       */
+      void wait();
+};
+
+/**
+ * @brief Runs queued tasks on the calling thread until done() holds, sleeping whenever there are none to run
+ * @note Whatever makes done() true must call notifyWaiters() afterwards, or a sleeping caller may not see it
+ */
+template <typename Done>
+void ThreadPool::runUntil(Done done) {
+   while (!done()) {
+      if (runPendingTask()) {
+         continue;
+      }
+      // checked under the same lock submit() and notifyWaiters() take before notifying, so no wake-up is missed
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      wake_.wait(lock, [this, &done] { return done() || queued_ > 0; });
+   }
+}
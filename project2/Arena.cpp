@@ -0,0 +1,63 @@
+#include "Arena.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+/**
+ * @brief Constructs an empty arena, which takes no memory until the first allocation
+ */
+Arena::Arena() : blocks_{}, cursor_{nullptr}, limit_{nullptr}, used_{0}, reserved_{0} {}
+
+/**
+ * @brief Frees every block
+ */
+Arena::~Arena() {
+    release();
+}
+
+/**
+ * @brief Returns bytes of uninitialized memory, aligned to align (a power of two), valid until release()
+ */
+void* Arena::allocate(size_t bytes, size_t align) {
+    uintptr_t at = (reinterpret_cast<uintptr_t>(cursor_) + align - 1) & ~(uintptr_t(align) - 1);
+    if (cursor_ == nullptr || at + bytes > reinterpret_cast<uintptr_t>(limit_)) {
+        // start a new block, big enough for this allocation even if it is larger than usual
+        size_t size = std::max(BLOCK_SIZE, bytes + align);
+        char* block = static_cast<char*>(::operator new(size));
+        blocks_.push_back(block);
+        reserved_ += size;
+        cursor_ = block;
+        limit_ = block + size;
+        at = (reinterpret_cast<uintptr_t>(cursor_) + align - 1) & ~(uintptr_t(align) - 1);
+    }
+    char* result = reinterpret_cast<char*>(at);
+    used_ += (result + bytes) - cursor_;
+    cursor_ = result + bytes;
+    return result;
+}
+
+/**
+ * @brief Frees every block at once, invalidating all memory handed out
+ */
+void Arena::release() {
+    for (char* block : blocks_) {
+        ::operator delete(block);
+    }
+    blocks_.clear();
+    cursor_ = limit_ = nullptr;
+    used_ = reserved_ = 0;
+}
+
+/**
+ * @brief Returns the bytes handed out so far, alignment padding included
+ */
+size_t Arena::used() const {
+    return used_;
+}
+
+/**
+ * @brief Returns the bytes of all blocks taken from the heap
+ */
+size_t Arena::reserved() const {
+    return reserved_;
+}
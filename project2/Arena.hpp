@@ -0,0 +1,66 @@
+/**
+ * @file Arena.hpp
+ * @brief Defines a bump allocator that hands out memory from large blocks and frees it all at once
+ */
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief A bump allocator: each allocation takes the next bytes of the current block, and nothing is freed individually
+ * Objects placed in an Arena must be trivially destructible (or have their destructors run by the owner), since
+ *    release() returns the blocks without visiting what is in them.
+ */
+class Arena {
+   public:
+      static constexpr size_t BLOCK_SIZE = 64 * 1024;   // The size of each block, unless one allocation needs more
+
+      /**
+       * @brief Constructs an empty arena, which takes no memory until the first allocation
+       */
+      Arena();
+
+      /**
+       * @brief Frees every block
+       */
+      ~Arena();
+
+      Arena(const Arena&) = delete;
+      Arena& operator=(const Arena&) = delete;
+
+      /**
+       * @brief Returns bytes of uninitialized memory, aligned to align (a power of two), valid until release()
+       */
+      void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+      /**
+       * @brief Allocates an uninitialized array of count T
+       */
+      template <typename T>
+      T* allocateArray(size_t count) {
+         return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+      }
+
+      /**
+       * @brief Frees every block at once, invalidating all memory handed out
+       */
+      void release();
+
+      /**
+       * @brief Returns the bytes handed out so far, alignment padding included
+       */
+      size_t used() const;
+
+      /**
+       * @brief Returns the bytes of all blocks taken from the heap
+       */
+      size_t reserved() const;
+
+   private:
+      std::vector<char*> blocks_;
+      char* cursor_;      // The next free byte of the current block
+      char* limit_;       // The end of the current block
+      size_t used_;
+      size_t reserved_;
+};
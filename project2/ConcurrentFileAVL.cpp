@@ -0,0 +1,318 @@
+#include "ConcurrentFileAVL.hpp"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+SharedNode::SharedNode(size_t size, std::shared_ptr<const std::vector<File*>> files, const SharedNode* lt, const SharedNode* rt, uint64_t version)
+    : size_{size}, files_{std::move(files)}, height_{std::max(lt ? lt->height_ : -1, rt ? rt->height_ : -1) + 1},
+      left_{lt}, right_{rt}, version_{version} {}
+
+/**
+ * @brief Default Constructor: Construct a new, empty ConcurrentFileAVL
+ */
+ConcurrentFileAVL::ConcurrentFileAVL() : current_{new Version{nullptr, 0}}, epoch_{1}, version_{0} {}
+
+/**
+ * @brief Destroy the tree, deallocating every Node. No Snapshot may outlive it.
+ */
+ConcurrentFileAVL::~ConcurrentFileAVL() {
+    const Version* current = current_.load();
+    deleteTree(current->root_);
+    delete current;
+    // retired Nodes are no longer part of the current tree, so each is freed on its own
+    for (const std::pair<uint64_t, const SharedNode*>& retired : retired_nodes_) {
+        delete retired.second;
+    }
+    for (const std::pair<uint64_t, const Version*>& retired : retired_versions_) {
+        delete retired.second;
+    }
+}
+
+/**
+ * @brief Destroys the given Node and its children
+ */
+void ConcurrentFileAVL::deleteTree(const SharedNode* t) {
+    if (t == nullptr) { return; }
+    deleteTree(t->left_);
+    deleteTree(t->right_);
+    delete t;
+}
+
+/**
+ * @brief Determines the height of a given Node, or -1 if given a nullptr
+ */
+int ConcurrentFileAVL::height(const SharedNode* t) {
+    return t == nullptr ? -1 : t->height_;
+}
+
+// =========== READERS  ===========
+
+/**
+ * @brief Claims a reader slot and announces the current epoch in it
+ * @return The index of the slot
+ */
+size_t ConcurrentFileAVL::enterRead() const {
+    // start from a slot picked by thread, so concurrent readers rarely contend for the same one
+    size_t slot = std::hash<std::thread::id>{}(std::this_thread::get_id()) % MAX_READERS;
+    for (size_t tried = 0; ; tried++, slot = (slot + 1) % MAX_READERS) {
+        if (tried > 0 && tried % MAX_READERS == 0) {
+            std::this_thread::yield();
+        }
+        uint64_t free = 0;
+        uint64_t epoch = epoch_.load();
+        if (!readers_[slot].epoch_.compare_exchange_strong(free, epoch)) {
+            continue;
+        }
+        // the epoch may have moved on before it was announced, in which case the writer may not have seen it: retry with the new one
+        for (uint64_t now = epoch_.load(); now != epoch; now = epoch_.load()) {
+            epoch = now;
+            readers_[slot].epoch_.store(epoch);
+        }
+        return slot;
+    }
+}
+
+/**
+ * @brief Releases a slot claimed by enterRead()
+ */
+void ConcurrentFileAVL::exitRead(size_t slot) const {
+    readers_[slot].epoch_.store(0);
+}
+
+/**
+ * @brief Takes a snapshot of the given tree, announcing the read before loading its root
+ */
+ConcurrentFileAVL::Snapshot::Snapshot(const ConcurrentFileAVL& tree) : tree_{tree}, slot_{tree.enterRead()} {
+    const Version* current = tree.current_.load();
+    root_ = current->root_;
+    size_ = current->size_;
+}
+
+/**
+ * @brief Ends the read, letting the writer free Nodes this snapshot could reach
+ */
+ConcurrentFileAVL::Snapshot::~Snapshot() {
+    tree_.exitRead(slot_);
+}
+
+/**
+ * @brief Retrieves all files in the snapshot whose file sizes are within [min, max]
+ *
+ * @param min The min value of the file size query range.
+ * @param max The max value of the file size query range.
+ * @return std::vector<File*> storing pointers to all files within the given range, in ascending order of size
+ * @note As with FileAVL::query, if min >= max the interval [max, min] is searched
+ */
+std::vector<File*> ConcurrentFileAVL::Snapshot::query(size_t min, size_t max) const {
+    if (min > max) {
+        std::swap(min, max);
+    }
+    std::vector<File*> result;
+    ConcurrentFileAVL::query(root_, min, max, result);
+    return result;
+}
+
+/**
+ * @brief Returns the number of files in the snapshot
+ */
+size_t ConcurrentFileAVL::Snapshot::size() const {
+    return size_;
+}
+
+/**
+ * @brief Appends the files of the subtree whose sizes are within [min, max], in order
+ */
+void ConcurrentFileAVL::query(const SharedNode* t, size_t min, size_t max, std::vector<File*>& result) {
+    if (t == nullptr) {
+        return;
+    }
+    if (t->size_ > min) {
+        query(t->left_, min, max, result);
+    }
+    if (t->size_ >= min && t->size_ <= max) {
+        result.insert(result.end(), t->files_->begin(), t->files_->end());
+    }
+    if (t->size_ < max) {
+        query(t->right_, min, max, result);
+    }
+}
+
+/**
+ * @brief Takes a snapshot, for several queries that must agree with each other
+ */
+ConcurrentFileAVL::Snapshot ConcurrentFileAVL::snapshot() const {
+    return Snapshot(*this);
+}
+
+/**
+ * @brief Retrieves all files whose file sizes are within [min, max], as of the moment the query starts
+ *
+ * @param min The min value of the file size query range.
+ * @param max The max value of the file size query range.
+ * @return std::vector<File*> storing pointers to all files within the given range, in ascending order of size
+ * @note As with FileAVL::query, if min >= max the interval [max, min] is searched. Never blocks on insert.
+ */
+std::vector<File*> ConcurrentFileAVL::query(size_t min, size_t max) const {
+    return Snapshot(*this).query(min, max);
+}
+
+/**
+ * @brief Returns the number of files in the tree
+ */
+size_t ConcurrentFileAVL::size() const {
+    return Snapshot(*this).size();
+}
+
+/**
+ * @brief Returns the number of replaced Nodes not yet freed, because a reader may still reach them
+ */
+size_t ConcurrentFileAVL::retiredCount() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return retired_nodes_.size();
+}
+
+// =========== WRITER  ===========
+
+/**
+ * @brief Inserts a file while maintaining balance, publishing the result to later readers at once
+ *    Files of equal size share a Node, in insertion order. Copies O(log n) Nodes, and the bucket target joins.
+ *
+ * @param target The file to be inserted
+ * @post Increases the size of the tree by 1. Safe to call from several threads, which are serialized.
+ */
+void ConcurrentFileAVL::insert(File* target) {
+    size_t size = target->getSize();
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    version_++;
+
+    const Version* old = current_.load();
+    const SharedNode* root = insert(target, size, old->root_);
+    current_.store(new Version{root, old->size_ + 1});
+
+    // readers that announce the next epoch can only have loaded the new root
+    uint64_t epoch = epoch_.fetch_add(1);
+    for (const SharedNode* t : replaced_) {
+        retired_nodes_.emplace_back(epoch, t);
+    }
+    replaced_.clear();
+    retired_versions_.emplace_back(epoch, old);
+    reclaim();
+}
+
+/**
+ * @brief Frees every retired Node no active reader can still reach
+ */
+void ConcurrentFileAVL::reclaim() {
+    // a reader that announced epoch e loaded its root after every insert retiring in an epoch before e had published
+    uint64_t oldest = UINT64_MAX;
+    for (const ReaderSlot& reader : readers_) {
+        uint64_t epoch = reader.epoch_.load();
+        if (epoch != 0) {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+    // both lists are in order of epoch
+    while (!retired_nodes_.empty() && retired_nodes_.front().first < oldest) {
+        delete retired_nodes_.front().second;
+        retired_nodes_.pop_front();
+    }
+    while (!retired_versions_.empty() && retired_versions_.front().first < oldest) {
+        delete retired_versions_.front().second;
+        retired_versions_.pop_front();
+    }
+}
+
+/**
+ * @brief Internal routine to insert into a subtree by copying the path to the changed Node
+ *
+ * @param target The file to insert
+ * @param size The size of target
+ * @param t The root of the subtree, which is left untouched
+ * @return The root of the new subtree
+ */
+const SharedNode* ConcurrentFileAVL::insert(File* target, size_t size, const SharedNode* t) {
+    if (t == nullptr) {
+        return make(size, std::make_shared<const std::vector<File*>>(1, target), nullptr, nullptr);
+    }
+
+    const SharedNode* copy;
+    if (size == t->size_) {
+        // readers may be walking the old bucket, so target joins a copy of it
+        auto files = std::make_shared<std::vector<File*>>(*t->files_);
+        files->push_back(target);
+        copy = make(size, std::move(files), t->left_, t->right_);
+    } else if (size < t->size_) {
+        copy = make(t->size_, t->files_, insert(target, size, t->left_), t->right_);
+    } else {
+        copy = make(t->size_, t->files_, t->left_, insert(target, size, t->right_));
+    }
+    replace(t);
+    return balance(copy);
+}
+
+/**
+ * @brief Makes a new Node for this insert
+ */
+const SharedNode* ConcurrentFileAVL::make(size_t size, std::shared_ptr<const std::vector<File*>> files, const SharedNode* lt, const SharedNode* rt) {
+    return new SharedNode(size, std::move(files), lt, rt, version_);
+}
+
+/**
+ * @brief Drops a Node replaced by this insert: freed at once if it was made by this insert, retired otherwise
+ */
+void ConcurrentFileAVL::replace(const SharedNode* t) {
+    if (t->version_ == version_) {
+        // never published, so no reader can have seen it
+        delete t;
+    } else {
+        replaced_.push_back(t);
+    }
+}
+
+/**
+ * @brief Returns a balanced copy of a Node, whose subtrees differ in height by at most 2
+ */
+const SharedNode* ConcurrentFileAVL::balance(const SharedNode* t) {
+    if (height(t->left_) - height(t->right_) > ALLOWED_IMBALANCE) {
+        if (height(t->left_->left_) < height(t->left_->right_)) {
+            // double rotation: first turn the left-right case into a left-left one
+            const SharedNode* turned = make(t->size_, t->files_, rotateWithRightChild(t->left_), t->right_);
+            replace(t);
+            t = turned;
+        }
+        return rotateWithLeftChild(t);
+    }
+    if (height(t->right_) - height(t->left_) > ALLOWED_IMBALANCE) {
+        if (height(t->right_->right_) < height(t->right_->left_)) {
+            const SharedNode* turned = make(t->size_, t->files_, t->left_, rotateWithLeftChild(t->right_));
+            replace(t);
+            t = turned;
+        }
+        return rotateWithRightChild(t);
+    }
+    return t;
+}
+
+/**
+ * @brief Returns a copy of k2 rotated with its left child
+ */
+const SharedNode* ConcurrentFileAVL::rotateWithLeftChild(const SharedNode* k2) {
+    const SharedNode* k1 = k2->left_;
+    const SharedNode* lowered = make(k2->size_, k2->files_, k1->right_, k2->right_);
+    const SharedNode* raised = make(k1->size_, k1->files_, k1->left_, lowered);
+    replace(k2);
+    replace(k1);
+    return raised;
+}
+
+/**
+ * @brief Returns a copy of k1 rotated with its right child
+ */
+const SharedNode* ConcurrentFileAVL::rotateWithRightChild(const SharedNode* k1) {
+    const SharedNode* k2 = k1->right_;
+    const SharedNode* lowered = make(k1->size_, k1->files_, k1->left_, k2->left_);
+    const SharedNode* raised = make(k2->size_, k2->files_, lowered, k2->right_);
+    replace(k1);
+    replace(k2);
+    return raised;
+}
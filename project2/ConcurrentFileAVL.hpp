@@ -0,0 +1,219 @@
+/**
+ * @file ConcurrentFileAVL.hpp
+ * @brief Defines a FileAVL variant whose queries run concurrently with inserts, without taking a lock
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "File.hpp"
+
+/**
+ * @brief An immutable Node of a ConcurrentFileAVL. Once published, a Node is never changed, only replaced.
+ */
+struct SharedNode {
+   size_t size_;
+   std::shared_ptr<const std::vector<File*>> files_;   // Shared by the copies of this Node made when its path is copied
+   int height_;                // The height of the Node
+   const SharedNode* left_;    // A pointer to Node's left child
+   const SharedNode* right_;   // A pointer to Node's right child
+   uint64_t version_;          // The insert that created this Node, so that insert can tell which Nodes are still private
+
+   SharedNode(size_t size, std::shared_ptr<const std::vector<File*>> files, const SharedNode* lt, const SharedNode* rt, uint64_t version);
+};
+
+/**
+ * @brief An AVL tree of files keyed by size, where queries never block and never see a half-done insert.
+ * Inserts copy the path from the root to the changed Node (rotations included) and publish the new root atomically,
+ *    so a reader keeps using whichever root it loaded. Replaced Nodes are freed with epoch-based reclamation:
+ *    each reader announces the epoch it started in, and a Node is only freed once every reader that could still
+ *    reach it has finished.
+ * Inserts are serialized with each other by a mutex.
+ */
+class ConcurrentFileAVL {
+   public:
+      /**
+       * @brief A consistent, read-only view of the tree as of when it was taken
+       * @note While a Snapshot exists, the Nodes it can reach are kept alive, so it should not be held for long.
+       *    At most MAX_READERS snapshots can exist at once; further ones wait for a free slot.
+       */
+      class Snapshot {
+         public:
+            /**
+             * @brief Retrieves all files in the snapshot whose file sizes are within [min, max]
+             *
+             * @param min The min value of the file size query range.
+             * @param max The max value of the file size query range.
+             * @return std::vector<File*> storing pointers to all files within the given range, in ascending order of size
+             * @note As with FileAVL::query, if min >= max the interval [max, min] is searched
+             */
+            std::vector<File*> query(size_t min, size_t max) const;
+
+            /**
+             * @brief Returns the number of files in the snapshot
+             */
+            size_t size() const;
+
+            /**
+             * @brief Ends the read, letting the writer free Nodes this snapshot could reach
+             */
+            ~Snapshot();
+
+            Snapshot(const Snapshot&) = delete;
+            Snapshot& operator=(const Snapshot&) = delete;
+
+         private:
+            friend class ConcurrentFileAVL;
+
+            const ConcurrentFileAVL& tree_;
+            size_t slot_;               // The reader slot this snapshot announced its epoch in
+            const SharedNode* root_;
+            size_t size_;
+
+            Snapshot(const ConcurrentFileAVL& tree);
+      };
+
+      /**
+       * @brief Default Constructor: Construct a new, empty ConcurrentFileAVL
+       */
+      ConcurrentFileAVL();
+
+      /**
+       * @brief Destroy the tree, deallocating every Node. No Snapshot may outlive it.
+       */
+      ~ConcurrentFileAVL();
+
+      ConcurrentFileAVL(const ConcurrentFileAVL&) = delete;
+      ConcurrentFileAVL& operator=(const ConcurrentFileAVL&) = delete;
+
+      /**
+       * @brief Inserts a file while maintaining balance, publishing the result to later readers at once
+       *    Files of equal size share a Node, in insertion order. Copies O(log n) Nodes, and the bucket target joins.
+       *
+       * @param target The file to be inserted
+       * @post Increases the size of the tree by 1. Safe to call from several threads, which are serialized.
+       */
+      void insert(File* target);
+
+      /**
+       * @brief Retrieves all files whose file sizes are within [min, max], as of the moment the query starts
+       *
+       * @param min The min value of the file size query range.
+       * @param max The max value of the file size query range.
+       * @return std::vector<File*> storing pointers to all files within the given range, in ascending order of size
+       * @note As with FileAVL::query, if min >= max the interval [max, min] is searched. Never blocks on insert.
+       */
+      std::vector<File*> query(size_t min, size_t max) const;
+
+      /**
+       * @brief Takes a snapshot, for several queries that must agree with each other
+       */
+      Snapshot snapshot() const;
+
+      /**
+       * @brief Returns the number of files in the tree
+       */
+      size_t size() const;
+
+      /**
+       * @brief Returns the number of replaced Nodes not yet freed, because a reader may still reach them
+       */
+      size_t retiredCount() const;
+
+      // The most readers (queries or snapshots) that can be active at once
+      static const size_t MAX_READERS = 64;
+
+   private:
+      static const int ALLOWED_IMBALANCE = 1;
+
+      // A reader's announced epoch, 0 when the slot is free; padded so readers on different cores do not share a line
+      struct alignas(64) ReaderSlot {
+         std::atomic<uint64_t> epoch_{0};
+      };
+
+      // A root together with the size of the tree it is the root of, published as one
+      struct Version {
+         const SharedNode* root_;
+         size_t size_;
+      };
+
+      std::atomic<const Version*> current_;
+      std::atomic<uint64_t> epoch_;                           // Advanced by every insert. Starts at 1, since 0 marks a free slot
+      mutable ReaderSlot readers_[MAX_READERS];
+      mutable std::mutex write_mutex_;
+      uint64_t version_;                                      // The number of inserts so far, guarded by write_mutex_
+      std::vector<const SharedNode*> replaced_;               // Published Nodes the current insert has replaced
+      std::deque<std::pair<uint64_t, const SharedNode*>> retired_nodes_;    // Replaced Nodes and the epoch they were replaced in
+      std::deque<std::pair<uint64_t, const Version*>> retired_versions_;
+
+      /**
+       * @brief Claims a reader slot and announces the current epoch in it
+       * @return The index of the slot
+       */
+      size_t enterRead() const;
+
+      /**
+       * @brief Releases a slot claimed by enterRead()
+       */
+      void exitRead(size_t slot) const;
+
+      /**
+       * @brief Internal routine to insert into a subtree by copying the path to the changed Node
+       *
+       * @param target The file to insert
+       * @param size The size of target
+       * @param t The root of the subtree, which is left untouched
+       * @return The root of the new subtree
+       */
+      const SharedNode* insert(File* target, size_t size, const SharedNode* t);
+
+      /**
+       * @brief Makes a new Node for this insert
+       */
+      const SharedNode* make(size_t size, std::shared_ptr<const std::vector<File*>> files, const SharedNode* lt, const SharedNode* rt);
+
+      /**
+       * @brief Drops a Node replaced by this insert: freed at once if it was made by this insert, retired otherwise
+       */
+      void replace(const SharedNode* t);
+
+      /**
+       * @brief Returns a balanced copy of a Node, whose subtrees differ in height by at most 2
+       */
+      const SharedNode* balance(const SharedNode* t);
+
+      /**
+       * @brief Returns a copy of k2 rotated with its left child
+       */
+      const SharedNode* rotateWithLeftChild(const SharedNode* k2);
+
+      /**
+       * @brief Returns a copy of k1 rotated with its right child
+       */
+      const SharedNode* rotateWithRightChild(const SharedNode* k1);
+
+      /**
+       * @brief Frees every retired Node no active reader can still reach
+       */
+      void reclaim();
+
+      /**
+       * @brief Determines the height of a given Node, or -1 if given a nullptr
+       */
+      static int height(const SharedNode* t);
+
+      /**
+       * @brief Appends the files of the subtree whose sizes are within [min, max], in order
+       */
+      static void query(const SharedNode* t, size_t min, size_t max, std::vector<File*>& result);
+
+      /**
+       * @brief Destroys the given Node and its children
+       */
+      static void deleteTree(const SharedNode* t);
+};
@@ -11,31 +11,49 @@
 * @param icon A poointer to an integer array with length ICON_DIM
 * @throws InvalidFormatException - An error that occurs if the filename is not valid by the above constraints.
 */
-File::File(const std::string& filename, const std::string& contents, int* icon) : filename_{""}, contents_{contents}, icon_{icon} {
-   if (filename.empty()) { filename_ = "NewFile.txt"; return; }
-   // Validate filename
-   auto dot_position = filename.end();
+File::File(const std::string& filename, const std::string& contents, int* icon) : filename_{normalizeName(filename)}, contents_{contents}, icon_{icon} {}
 
-   for (auto itr = filename.begin(); itr != filename.end(); ++itr) {
-      const char& c = *itr;
-      
-      if (dot_position == filename.end() && c == '.') {
-         // If the dot_position has not been set (ie. equals the end) and we encounter a period
-         dot_position = itr;
-      } else if (!std::isalnum(c)) {
-         // We have found a non-alphanumeric character (including possibly *another* period by failing the first if-clause)
-         throw InvalidFormatException("Invalid file name: " + filename);
-      }
+/**
+ * @brief Constructs an empty File from an already validated and normalized filename
+ */
+File::File(FileName&& normalized_name, NormalizedTag) : filename_{std::move(normalized_name)}, contents_{}, icon_{nullptr} {}
+
+/**
+ * @brief Validates a filename and applies the constructor's defaults (NewFile.txt, the .txt extension)
+ * @return The filename as it will be stored
+ * @throws InvalidFormatException if the filename is not valid
+ */
+FileName File::normalizeName(const std::string& filename) {
+   if (filename.empty()) { return FileName("NewFile.txt"); }
+
+   FilenameCheck check = checkFilename(filename.data(), filename.size());
+   if (!check.valid_) {
+      // We have found a non-alphanumeric character (including possibly *another* period)
+      throw InvalidFormatException("Invalid file name: " + filename);
+   }
+   if (check.period_ != std::string::npos && check.period_ + 1 < filename.size()) {
+      return FileName(filename);
    }
 
-   filename_ = std::string(filename.begin(), dot_position);
-   
-   if (filename.end() - dot_position <= 1) {
-      // No period specified / no extension characters
-      filename_ += ".txt";
-   } else {
-      filename_ += std::string(dot_position, filename.end());
-   }   
+   // No period specified / no extension characters: join the base and the default extension in place
+   size_t base_length = (check.period_ == std::string::npos) ? filename.size() : check.period_;
+   return FileName(std::string_view(filename).substr(0, base_length), ".txt");
+}
+
+/**
+ * @brief Constructs one File per name, validating and normalizing the whole batch into storage reserved up front
+ * 
+ * @param names The filenames, with the same rules as the constructor
+ * @return The new Files (with empty contents and no icon), in the order of names
+ * @throws InvalidFormatException if any name is invalid
+ */
+std::vector<File> File::fromNames(const std::vector<std::string>& names) {
+   std::vector<File> files;
+   files.reserve(names.size());
+   for (const std::string& name : names) {
+      files.emplace_back(normalizeName(name), NormalizedTag{});
+   }
+   return files;
 }
       
 /**
@@ -45,7 +63,7 @@ File::File(const std::string& filename, const std::string& contents, int* icon)
    * @return std::string 
    */
 std::string File::getName() const {
-   return filename_;
+   return filename_.str();
 }
 
 /**
@@ -64,6 +82,27 @@ std::string File::getContents() const {
    return contents_;
 }
 
+/**
+   * @brief Get a read-only view of name_, without copying it
+   */
+std::string_view File::getNameView() const {
+   return filename_.view();
+}
+
+/**
+   * @brief Get the stored name, with its precomputed hash and extension position
+   */
+const FileName& File::getFileName() const {
+   return filename_;
+}
+
+/**
+   * @brief Get a read-only view of contents_, without copying it
+   */
+std::string_view File::getContentsView() const {
+   return contents_;
+}
+
 
 /**
 * @brief Gets the value of the icon_ member
@@ -92,7 +131,7 @@ File::~File() {
 /**
 * @brief (COPY CONSTRUCTOR) Constructs a new File object as a deep copy of the target File
 */
-File::File(const File& rhs) : filename_{rhs.getName()}, contents_{rhs.getContents()}, icon_{nullptr} {
+File::File(const File& rhs) : filename_{rhs.filename_}, contents_{rhs.contents_}, icon_{nullptr} {
    if (rhs.getIcon() == nullptr) { return; }
    
    // Create a deep copy of the icon array
@@ -110,8 +149,8 @@ File& File::operator=(const File& rhs) {
    // Check for self-assignment (otherwise we delete the icon and try to copy it. No bueno!)
    if (this == &rhs) { return *this; }
 
-   filename_ = rhs.getName();
-   contents_ = rhs.getContents();
+   filename_ = rhs.filename_;
+   contents_ = rhs.contents_;
    
    // Since we don't validate unique icons, we may unintentionally 
    // assign the same icon (via setter). Maybe (as pure hypothetical)
@@ -190,5 +229,5 @@ std::ostream& operator<< (std::ostream& os, const File& target) {
  * @brief Compaeres files based on their names, lexicographically
  */
 bool File::operator<(const File& rhs) const {
-   return getName() < rhs.getName();
+   return filename_ < rhs.filename_;
 }
\ No newline at end of file
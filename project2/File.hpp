@@ -2,20 +2,48 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iterator>
 #include <cstdint>
 #include "InvalidFormatException.hpp"
+#include "FilenameValidator.hpp"
+#include "FileName.hpp"
 
 class File {
    private:
-      std::string filename_;
+      FileName filename_;   // Stored inline for names up to FileName::INLINE_CAPACITY bytes
       std::string contents_;
       int* icon_;
 
       static const size_t ICON_DIM = 256; // Representing a 16 x 16 bitmap
 
+      // Marks a filename that has already been through normalizeName(). Only File can create one.
+      struct NormalizedTag {};
+
+      /**
+       * @brief Validates a filename and applies the constructor's defaults (NewFile.txt, the .txt extension)
+       * @return The filename as it will be stored
+       * @throws InvalidFormatException if the filename is not valid
+       */
+      static FileName normalizeName(const std::string& filename);
+
    public: 
+      /**
+       * @brief Constructs an empty File from an already validated and normalized filename
+       * @note Public so std::vector can construct Files in place, but only File can supply the tag
+       */
+      File(FileName&& normalized_name, NormalizedTag);
+
+      /**
+       * @brief Constructs one File per name, validating and normalizing the whole batch into storage reserved up front
+       * 
+       * @param names The filenames, with the same rules as the constructor
+       * @return The new Files (with empty contents and no icon), in the order of names
+       * @throws InvalidFormatException if any name is invalid
+       */
+      static std::vector<File> fromNames(const std::vector<std::string>& names);
+
       /**
       * @brief Constructs a new File object.
       * 
@@ -52,6 +80,23 @@ class File {
        */
       std::string getContents() const;
 
+      /**
+       * @brief Get a read-only view of name_, without copying it
+       * @note The view is invalidated when the File is modified, moved from or destroyed
+       */
+      std::string_view getNameView() const;
+
+      /**
+       * @brief Get the stored name, with its precomputed hash and extension position
+       */
+      const FileName& getFileName() const;
+
+      /**
+       * @brief Get a read-only view of contents_, without copying it
+       * @note The view is invalidated when the File is modified, moved from or destroyed
+       */
+      std::string_view getContentsView() const;
+
       /**
       * @brief Calculates and returns the size of the File Object (in bytes)
       *    by summing the size of the file's content member using sizeOf()
@@ -6,208 +6,466 @@
  * @param n A pointer to a node to be examined
  * @return The height of the given node, or -1 if given a nullptr
  */
-int FileAVL::height(Node* n) const {
-   if (n == nullptr) {
-      return -1;
-   }
-   return n->height_;
+int FileAVL::height(const Node* n) const {
+   return index_.height(n);
 }
 
 /**
  * @brief Returns the size of the AVL tree
  */
 int FileAVL::size() const {
-   return size_;
+   return index_.size();
+}
+
+/**
+* @brief Prints the level-order traversal of the tree
+*/
+void FileAVL::displayLevelOrder() const {
+   index_.displayLevelOrder();
+}
+
+/**
+ * @brief Prints the unique file sizes of the FileAVL in-order
+ */
+void FileAVL::displayInOrder() const {
+    index_.displayInOrder();
 }
 
 /**
- * @brief Prints the value of the specified Node t and its children using level-order traversal
+ * @brief Appends the sizes and files of the subtree in-order, recording where each bucket starts
  */
-void FileAVL::displayLevelOrder(Node* t) const {
+void FileAVL::flatten(const Node* t, std::vector<size_t>& sizes, std::vector<size_t>& offsets, std::vector<File*>& files) const {
     if (!t) { return; }
-    
-    std::queue<Node*> current, next;
-    current.push(t);
-
-    while (!current.empty()) {
-        while (!current.empty()) {
-            Node*& front = current.front();
-            if (front->left_) { next.push(front->left_); }   
-            if (front->right_) { next.push(front->right_); }
-            std::cout << front->size_ << " ";
-            current.pop();
-        }
-        std::cout << std::endl;
-        current = std::move(next);
-    }
+
+    flatten(t->left_, sizes, offsets, files);
+    sizes.push_back(t->key_);
+    offsets.push_back(files.size());
+    files.insert(files.end(), t->files_.begin(), t->files_.end());
+    flatten(t->right_, sizes, offsets, files);
 }
 
 /**
-* @brief Prints the level-order traversal of the specified subtree 
-*/
-void FileAVL::displayLevelOrder() const {
-   displayLevelOrder(root_);   
+ * @brief The ranges of a queryMany() call sorted by min, with what is needed to test them against a subtree and a sweep
+ *    over them that follows the in-order traversal
+ */
+struct FileAVL::RangeSweep {
+    std::vector<size_t> order;      // Indices of the ranges in ascending order of min
+    std::vector<size_t> mins;       // mins[i] is the min of range order[i]
+    std::vector<size_t> reach;      // reach[i] is the largest max among ranges order[0..i]
+    std::vector<size_t> maxes;      // maxes[r] is the max of range r, in the order given
+    std::vector<size_t> active;     // Ranges that hold the size last visited
+    size_t started = 0;             // The number of ranges (in sorted order) with min no larger than the size last visited
+    std::vector<std::vector<File*>> results;
+
+    /**
+     * @brief Determines whether any range overlaps [lo, hi]
+     */
+    bool overlaps(size_t lo, size_t hi) const {
+        size_t below = std::upper_bound(mins.begin(), mins.end(), hi) - mins.begin();
+        return below > 0 && reach[below - 1] >= lo;
+    }
+};
+
+/**
+ * @brief Answers several range queries in one ordered traversal of the tree
+ * 
+ * @param ranges The [min, max] ranges to query, in any order, and possibly overlapping
+ * @return One vector per range, in the order the ranges were given, each holding what query(min, max) would return
+ * @note Bounds are swapped as in query. Each Node in any range is visited once, and subtrees in the gaps between
+ *    ranges are skipped.
+ */
+std::vector<std::vector<File*>> FileAVL::queryMany(const std::vector<std::pair<size_t, size_t>>& ranges) const {
+    RangeSweep sweep;
+    std::vector<size_t> mins(ranges.size());
+    sweep.maxes.resize(ranges.size());
+    for (size_t r = 0; r < ranges.size(); r++) {
+        mins[r] = std::min(ranges[r].first, ranges[r].second);
+        sweep.maxes[r] = std::max(ranges[r].first, ranges[r].second);
+        sweep.order.push_back(r);
+    }
+    std::sort(sweep.order.begin(), sweep.order.end(), [&](size_t lhs, size_t rhs) { return mins[lhs] < mins[rhs]; });
+    for (size_t r : sweep.order) {
+        sweep.mins.push_back(mins[r]);
+        sweep.reach.push_back(sweep.reach.empty() ? sweep.maxes[r] : std::max(sweep.reach.back(), sweep.maxes[r]));
+    }
+    sweep.results.resize(ranges.size());
+
+    queryMany(index_.root(), 0, SIZE_MAX, sweep);
+    return std::move(sweep.results);
 }
 
 /**
- * @brief Wrapper for printing the unique file sizes of the FileAVL in-order
+ * @brief Internal routine of queryMany(): walks the subtree in-order, skipping it if no range overlaps its sizes
+ * 
+ * @param t The root of the subtree
+ * @param lo The smallest size the subtree can hold
+ * @param hi The largest size the subtree can hold
+ * @param sweep The ranges, and the results collected so far
  */
-void FileAVL::displayInOrder() const {
-    if (!root_) { return; }
-    displayInOrder(root_);
-    std::cout << std::endl;
+void FileAVL::queryMany(const Node* t, size_t lo, size_t hi, RangeSweep& sweep) const {
+    if (t == nullptr || !sweep.overlaps(lo, hi)) {
+        return;
+    }
+
+    size_t size = t->key_;
+    if (size > lo) {
+        queryMany(t->left_, lo, size - 1, sweep);
+    }
+
+    // sizes are visited in increasing order, so ranges only ever start (in sorted order) and finish
+    while (sweep.started < sweep.mins.size() && sweep.mins[sweep.started] <= size) {
+        sweep.active.push_back(sweep.order[sweep.started++]);
+    }
+    auto finished = [&](size_t r) { return sweep.maxes[r] < size; };
+    sweep.active.erase(std::remove_if(sweep.active.begin(), sweep.active.end(), finished), sweep.active.end());
+    for (size_t r : sweep.active) {
+        sweep.results[r].insert(sweep.results[r].end(), t->files_.begin(), t->files_.end());
+    }
+
+    if (size < hi) {
+        queryMany(t->right_, size + 1, hi, sweep);
+    }
 }
 
 /**
- * @brief Helper for displayInOrder(). Prints the unique file sizes in-order given a specified root
- * @param root The root of the tree to be printed
+ * @brief Takes an immutable snapshot of the tree in a cache-friendly array layout, for read-heavy range queries
+ * @see FrozenFileAVL
  */
-void FileAVL::displayInOrder(Node* root) const {
-    if (!root) { return; }
-    
-    displayInOrder(root->left_);
-    std::cout << root->files_[0]->getSize() << " ";
-    displayInOrder(root->right_);
+FrozenFileAVL FileAVL::freeze() const {
+    std::vector<size_t> sizes, offsets;
+    std::vector<File*> files;
+    files.reserve(index_.size());
+    flatten(index_.root(), sizes, offsets, files);
+    offsets.push_back(files.size());
+    return FrozenFileAVL(sizes, std::move(offsets), std::move(files));
 }
 
 /**
- * @brief Default Constructor: Construct a new FileAVL object
+ * @brief Counts and totals the files smaller than key (or no larger than it, if inclusive)
+ * 
+ * @param key The size to compare against
+ * @param inclusive Whether files of exactly key are included
+ * @param count Set to the number of such files
+ * @param bytes Set to the total size of such files
  */
-FileAVL::FileAVL() : root_ {nullptr}, size_{0} {}
+void FileAVL::countBelow(size_t key, bool inclusive, size_t& count, size_t& bytes) const {
+    count = 0;
+    bytes = 0;
+    const Node* current = index_.root();
+    while (current != nullptr) {
+        if (current->key_ < key || (inclusive && current->key_ == key)) {
+            // this Node and its whole left subtree are below key
+            if (current->left_) {
+                count += current->left_->count_;
+                bytes += current->left_->bytes_;
+            }
+            count += current->files_.size();
+            bytes += current->key_ * current->files_.size();
+            current = current->right_;
+        } else {
+            current = current->left_;
+        }
+    }
+}
 
- /**
- * @brief Destroys the given Node and its children
+/**
+ * @brief Counts the files whose sizes are within [min, max] without collecting them
  * 
- * @param t The node to be deleted
+ * @param min The min value of the file size query range.
+ * @param max The max value of the file size query range.
+ * @return The number of files query(min, max) would return
+ * @note As with query, if min >= max the interval [max, min] is counted. Runs in O(log n).
  */
-void FileAVL::deleteTree(Node*& t) {
-   if (t == nullptr) { return; }
-   deleteTree(t->left_);
-   deleteTree(t->right_);
-   delete t;
-   t = nullptr;
+size_t FileAVL::countInRange(size_t min, size_t max) const {
+    if (min > max) {
+        std::swap(min, max);
+    }
+    size_t below, upTo, bytes;
+    countBelow(min, false, below, bytes);
+    countBelow(max, true, upTo, bytes);
+    return upTo - below;
 }
 
 /**
- * @brief Destroy the FileAVL, deallocating all necessary Nodes
+ * @brief Totals the sizes of the files whose sizes are within [min, max] without collecting them
+ * 
+ * @param min The min value of the file size query range.
+ * @param max The max value of the file size query range.
+ * @return The sum of getSize() over the files query(min, max) would return
+ * @note As with query, if min >= max the interval [max, min] is totalled. Runs in O(log n).
  */
-FileAVL::~FileAVL() {
-   deleteTree(root_);
+size_t FileAVL::bytesInRange(size_t min, size_t max) const {
+    if (min > max) {
+        std::swap(min, max);
+    }
+    size_t count, below, upTo;
+    countBelow(min, false, count, below);
+    countBelow(max, true, count, upTo);
+    return upTo - below;
 }
 
 /**
- * @brief Inserts a specified value into the AVL tree while maintaining balance
- *    If a duplicate is found, increments the count within the Node of the associated value
+ * @brief Finds the file at a given position of the in-order listing query(0, SIZE_MAX) would return
  * 
- * @param target The value to be inserted
- * @post Increases the size of the tree by 1
+ * @param k The 0-based position of the file
+ * @return The k-th smallest file, or nullptr if k >= size(). Runs in O(log n).
  */
-void FileAVL::insert(File* target) {
-   insert(target, root_);
-   size_++;
+File* FileAVL::kthSmallest(size_t k) const {
+    const Node* current = index_.root();
+    while (current != nullptr) {
+        size_t left = current->left_ ? current->left_->count_ : 0;
+        if (k < left) {
+            current = current->left_;
+        } else if (k - left < current->files_.size()) {
+            // within a bucket, files are listed in insertion order
+            return current->files_[k - left];
+        } else {
+            k -= left + current->files_.size();
+            current = current->right_;
+        }
+    }
+    return nullptr;
 }
 
 /**
- * @brief Internal routine to insert into a subtree
+ * @brief Counts the files strictly smaller than a given size
  * 
- * @param target The value to insert
- * @param subroot The root of the subtree to be inserted into
- * @post Set the new root of the subtree
- */
-void FileAVL::insert(File*& target, Node*& subroot) {
-   if (subroot == nullptr) {
-      subroot = new Node({ target });
-   } else if (target->getSize() == subroot->files_.front()->getSize()) {
-      subroot->files_.push_back(target);
-   } else if (target->getSize() < subroot->files_.front()->getSize()) {
-      insert(target, subroot->left_);
-   } else {
-      insert(target, subroot->right_);
-   }
+ * @param size The size to rank
+ * @return The position at which the first file of at least the given size appears, so that
+ *    kthSmallest(rankOf(size)) is that file. Runs in O(log n).
+ */
+size_t FileAVL::rankOf(size_t size) const {
+    size_t count, bytes;
+    countBelow(size, false, count, bytes);
+    return count;
+}
 
-   balance(subroot);
+/**
+ * @brief Starts a walk of [min, max] over the tree rooted at root, beginning at size from
+ *    (min, or max if reverse) just after the file after in that size's bucket. If after is not there,
+ *    the first skip files of the bucket are skipped instead.
+ */
+FileCursor::FileCursor(const Node* root, size_t min, size_t max, bool reverse, size_t from, size_t skip, File* after)
+    : depth_{0}, current_{nullptr}, index_{0}, lo_{reverse ? min : from}, hi_{reverse ? from : max}, min_{min}, max_{max}, reverse_{reverse} {
+    descend(root);
+    advance();
+    if (current_ == nullptr || current_->key_ != from || after == nullptr) {
+        return;
+    }
+    // index_ counts from the back when reversed, so files appended since the token was taken are still ahead
+    const std::vector<File*>& bucket = current_->files_;
+    auto found = std::find(bucket.begin(), bucket.end(), after);
+    if (found != bucket.end()) {
+        size_t position = found - bucket.begin();
+        index_ = reverse_ ? bucket.size() - position : position + 1;
+    } else {
+        index_ = skip > 0 ? skip - 1 : 0;
+    }
 }
 
 /**
- * @brief Balance the given Node
+ * @brief Pushes the Nodes within bounds on the path from t toward the next size to be walked
+ */
+void FileCursor::descend(const Node* t) {
+    while (t != nullptr) {
+        if (reverse_ ? t->key_ > hi_ : t->key_ < lo_) {
+            // t and everything on its near side are out of bounds
+            t = reverse_ ? t->left_ : t->right_;
+        } else {
+            stack_[depth_++] = t;
+            t = reverse_ ? t->right_ : t->left_;
+        }
+    }
+}
+
+/**
+ * @brief Moves current_ to the next bucket in range, or to nullptr if there is none
+ */
+void FileCursor::advance() {
+    if (depth_ == 0) {
+        current_ = nullptr;
+        return;
+    }
+    const Node* t = stack_[--depth_];
+    if (reverse_ ? t->key_ < lo_ : t->key_ > hi_) {
+        // every Node left on the stack is further still
+        current_ = nullptr;
+        depth_ = 0;
+        return;
+    }
+    current_ = t;
+    index_ = 0;
+    descend(reverse_ ? t->left_ : t->right_);
+}
+
+/**
+ * @brief Returns the next file of the range, or nullptr once there are none left
+ */
+File* FileCursor::next() {
+    while (current_ != nullptr && index_ >= current_->files_.size()) {
+        advance();
+    }
+    if (current_ == nullptr) {
+        return nullptr;
+    }
+    const std::vector<File*>& bucket = current_->files_;
+    File* file = reverse_ ? bucket[bucket.size() - 1 - index_] : bucket[index_];
+    index_++;
+    return file;
+}
+
+/**
+ * @brief Appends up to count of the next files of the range to out
  * 
- * @param t The Node to be balanced
+ * @return The number of files appended, which is less than count only once the range is exhausted
  */
-void FileAVL::balance(Node* &t) {
-   if (t == nullptr) {
-      return ;
-   }
+size_t FileCursor::take(std::vector<File*>& out, size_t count) {
+    size_t taken = 0;
+    while (taken < count) {
+        File* file = next();
+        if (file == nullptr) {
+            break;
+        }
+        out.push_back(file);
+        taken++;
+    }
+    return taken;
+}
 
-   if ( height(t->left_) - height(t->right_) > ALLOWED_IMBALANCE) {
-      if ( height( t->left_->left_ ) >= height( t->left_->right_ ) ) {
-         rotateWithLeftChild(t);
-      } else {
-         doubleWithLeftChlid(t);
-      }
-   } else {
-      if (  height( t->right_ ) - height( t->left_ ) > ALLOWED_IMBALANCE ) {
-         if( height( t->right_->right_ ) >= height( t->right_->left_ ) )
-            rotateWithRightChild( t );
-         else {
-            doubleWithRightChild( t );
-         }
-      }
-   }
+/**
+ * @brief Returns a token from which FileAVL::resume() continues after the last file returned
+ */
+PageToken FileCursor::token() const {
+    if (current_ == nullptr) {
+        return PageToken{min_, max_, reverse_, 0, 0, nullptr, true};
+    }
+    const std::vector<File*>& bucket = current_->files_;
+    File* last = nullptr;
+    if (index_ > 0) {
+        last = reverse_ ? bucket[bucket.size() - index_] : bucket[index_ - 1];
+    }
+    return PageToken{min_, max_, reverse_, current_->key_, index_, last, false};
+}
 
-   t->height_ = std::max( height( t->left_ ), height( t->right_ ) ) + 1;
+/**
+ * @brief Walks the files whose sizes are within [min, max] lazily, in ascending order of size (descending if reverse)
+ * 
+ * @param min The min value of the file size query range.
+ * @param max The max value of the file size query range.
+ * @param reverse Whether to return the largest files first
+ * @return A cursor positioned before the first file. Within a bucket, files come in insertion order (reversed if reverse).
+ * @note As with query, if min >= max the interval [max, min] is walked
+ */
+FileCursor FileAVL::cursor(size_t min, size_t max, bool reverse) const {
+    if (min > max) {
+        std::swap(min, max);
+    }
+    return FileCursor(index_.root(), min, max, reverse, reverse ? max : min, 0, nullptr);
 }
 
 /**
- * @brief Performs a rotation on k2 with its left child
+ * @brief Continues a walk from a token taken from an earlier cursor
  * 
- * @param k2 The node to be brought down to its left child
- * @post k2 is set to the rotated root (ie. its initial left child); 
- * Both nodes roots are updated to reflect the rotation
+ * @param token The place to continue from, carrying the range and direction of the original walk
+ * @return A cursor positioned before the first file not yet returned
  */
-void FileAVL::rotateWithLeftChild(Node*& k2) {
-   Node* k1 = k2->left_;
-   k2->left_ = k1->right_;
-   k1->right_ = k2;
+FileCursor FileAVL::resume(const PageToken& token) const {
+    const Node* root = token.done_ ? nullptr : index_.root();
+    return FileCursor(root, token.min_, token.max_, token.reverse_, token.size_, token.offset_, token.last_);
+}
+
+/**
+ * @brief Returns a sketch of the sizes of the files in the tree, kept current by every insert, removal and bulk load
+ * @see SizeSketch for its quantile and CDF queries and their error
+ */
+const SizeSketch& FileAVL::sizeSketch() const {
+    return sketch_;
+}
 
-   k2->height_ = std::max( height( k2->left_ ), height( k2->right_ ) ) + 1;
-   k1->height_ = std::max( height( k1->left_ ), k2->height_ ) + 1;
-   k2 = k1;
+/**
+ * @brief Default Constructor: Construct a new FileAVL object
+ */
+FileAVL::FileAVL() : index_{}, sketch_{} {}
+
+/**
+ * @brief Destroy the FileAVL, deallocating all necessary Nodes
+ */
+FileAVL::~FileAVL() {}
+
+/**
+ * @brief Inserts a specified value into the AVL tree while maintaining balance
+ *    If a duplicate is found, increments the count within the Node of the associated value
+ * 
+ * @param target The value to be inserted
+ * @post Increases the size of the tree by 1
+ */
+void FileAVL::insert(File* target) {
+   // read the size once, for both the tree and the sketch
+   size_t size = target->getSize();
+   index_.insert(target, size);
+   sketch_.add(size);
 }
 
 /**
- * @brief Performs a rotation on k1 with its right child
+ * @brief Replaces the contents of the tree with the given files, building a perfectly balanced tree bottom-up
+ *    Files of equal size share a Node, in the order they were given (as if inserted one by one)
  * 
- * @param k1 The node to be brought down to its right child
- * @post k1 is set to the rotated root (ie. its initial right child); 
- * Both nodes roots are updated to reflect the rotation
+ * @param files The files to index
+ * @param presorted If true, files must already be in non-decreasing order of size and the sort is skipped
+ * @post Runs in O(n) after the O(n log n) sort, calling getSize() once per file
  */
-void FileAVL::rotateWithRightChild(Node*& k1) {
-   Node* k2 = k1->right_;
-   k1->right_ = k2->left_;
-   k2->left_ = k1;
-   k1->height_ = 1 + std::max( height( k1->left_ ), height( k1->right_ ));
-   k2->height_ = 1 + std::max( k1->height_, height(k2->right_) );
-   k1 = k2;
+void FileAVL::build(std::vector<File*> files, bool presorted) {
+   index_.build(std::move(files), presorted);
+   sketch_.clear();
+   sketchBuckets(index_.root());
 }
 
 /**
- * @brief Performs a double rotation to fix a left-right imbalance about k3
+ * @brief Adds the buckets of the subtree to the sketch, one call per distinct size
+ */
+void FileAVL::sketchBuckets(const Node* t) {
+   if (t == nullptr) { return; }
+   sketchBuckets(t->left_);
+   sketch_.add(t->key_, t->files_.size());
+   sketchBuckets(t->right_);
+}
+
+/**
+ * @brief Removes a file from the AVL tree while maintaining balance
+ *    Its Node is dropped once no other file of the same size remains in it
  * 
- * @param k3 The parent Node with a left-right imbalance
- * @post Updates heights, sets new root
+ * @param target The file to be removed, looked up by its current size
+ * @return True if the file was found and removed. False otherwise.
+ * @post If removed, decreases the size of the tree by 1
  */
-void FileAVL::doubleWithLeftChlid(Node*& k3) {
-   rotateWithRightChild( k3->left_ );
-   rotateWithLeftChild( k3 );
+bool FileAVL::remove(File* target) {
+   size_t size = target->getSize();
+   if (!index_.remove(target, size)) {
+      return false;
+   }
+   sketch_.remove(size);
+   return true;
 }
 
 /**
- * @brief Performs a double rotation to fix a right-left imbalance about k3
+ * @brief Moves a file to the Node matching its current size after its contents changed
  * 
- * @param k3 The parent Node with a right-left imbalance
- * @post Updates heights, sets new root
+ * @param target A file already in the tree
+ * @param old_size The size target had when it was inserted (or last updated)
+ * @return True if the file was found under old_size. False otherwise, in which case the tree is unchanged.
  */
-void FileAVL::doubleWithRightChild(Node*& k3) {
-   rotateWithLeftChild(k3->right_);
-   rotateWithRightChild(k3);
-}
\ No newline at end of file
+bool FileAVL::updateSize(File* target, size_t old_size) {
+   size_t new_size = target->getSize();
+   if (new_size == old_size) {
+      // still filed under the right Node, but only report success if it is actually there
+      const Node* bucket = index_.node(old_size);
+      return bucket != nullptr && std::find(bucket->files_.begin(), bucket->files_.end(), target) != bucket->files_.end();
+   }
+   if (!index_.remove(target, old_size)) {
+      return false;
+   }
+   index_.insert(target, new_size);
+   sketch_.remove(old_size);
+   sketch_.add(new_size);
+   return true;
+}
@@ -10,17 +10,113 @@
 #include <iostream>
 
 #include "File.hpp"
-#include <queue>
-
-struct Node {
-   size_t size_;    
-   std::vector<File*> files_;
-   int height_;   // The height of the Node
-   Node *left_;   // A pointer to Node's left child
-   Node *right_;  // A pointer to Node's right child
-   
-   // Parameterized constructor for a Node
-   Node(File* f, Node* lt=nullptr, Node* rt=nullptr) : size_{f->getSize()}, files_{ {f} }, height_{0}, left_{lt}, right_{rt} {}
+#include "FileIndex.hpp"
+#include "FrozenFileAVL.hpp"
+#include "SizeSketch.hpp"
+
+/**
+ * @brief The augmentation of the FileAVL's Nodes with the number and total size of the files in each subtree,
+ *    which answer counts, byte totals and ranks in O(log n)
+ */
+struct SizeTotals {
+   struct Fields {
+      size_t count_; // The number of files in the subtree rooted at this Node
+      size_t bytes_; // The total size of the files in the subtree rooted at this Node
+   };
+
+   template <typename Node>
+   static void update(Node* t) {
+      t->count_ = t->files_.size();
+      t->bytes_ = t->key_ * t->files_.size();
+      if (t->left_) {
+         t->count_ += t->left_->count_;
+         t->bytes_ += t->left_->bytes_;
+      }
+      if (t->right_) {
+         t->count_ += t->right_->count_;
+         t->bytes_ += t->right_->bytes_;
+      }
+   }
+};
+
+// A FileAVL is a size index whose Nodes keep SizeTotals. A Node's key_ is the size of its files.
+using FileSizeTree = FileIndex<SizeKey, std::less<size_t>, SizeTotals>;
+using Node = FileSizeTree::IndexNode;
+
+/**
+ * @brief Records where a FileCursor stopped, so a later cursor can pick up from the same place
+ * @note The position is the last file returned, found again in its size's bucket when resuming, so a token stays
+ *    usable after the tree changes: files inserted into or removed from the rest of the range are simply seen or not
+ *    seen, and no file is skipped or returned twice. The one exception is when last_ itself has since been removed
+ *    or resized; the walk then continues from offset_, which is exact only if its bucket has not otherwise changed.
+ */
+struct PageToken {
+   size_t min_;        // The bounds of the range being walked
+   size_t max_;
+   bool reverse_;      // Whether the walk is largest-first
+   size_t size_;       // The size of the bucket holding the next file
+   size_t offset_;     // The number of files of that bucket already returned
+   File* last_;        // The last of them, or nullptr if none have been
+   bool done_;         // Whether the walk has run out of files
+};
+
+/**
+ * @brief Walks the files of a FileAVL whose sizes are within a range, one at a time, in size order
+ *    Nodes still to be visited are kept on a fixed-size stack, so no step allocates.
+ * @note A cursor points into the tree, so any insert or remove invalidates it. 
+ *    Use token() and FileAVL::resume() to continue across changes.
+ */
+class FileCursor {
+   public:
+      /**
+       * @brief Returns the next file of the range, or nullptr once there are none left
+       */
+      File* next();
+
+      /**
+       * @brief Appends up to count of the next files of the range to out
+       * 
+       * @return The number of files appended, which is less than count only once the range is exhausted
+       */
+      size_t take(std::vector<File*>& out, size_t count);
+
+      /**
+       * @brief Returns a token from which FileAVL::resume() continues after the last file returned
+       */
+      PageToken token() const;
+
+   private:
+      friend class FileAVL;
+
+      // An AVL tree of height h holds at least Fib(h + 3) - 1 Nodes, so 96 levels cover any tree that fits in memory
+      static const int MAX_DEPTH = 96;
+
+      const Node* stack_[MAX_DEPTH];   // Nodes whose buckets are still to be returned, the next one on top
+      int depth_;
+      const Node* current_;            // The Node whose bucket is being returned, or nullptr once the range is exhausted
+      size_t index_;             // The number of files of current_ already returned
+      size_t lo_;                // The bounds still to be walked, which narrow the original ones when resuming
+      size_t hi_;
+      size_t min_;               // The original bounds, carried into tokens
+      size_t max_;
+      bool reverse_;
+
+      /**
+       * @brief Starts a walk of [min, max] over the tree rooted at root, beginning at size from
+       *    (min, or max if reverse) just after the file after in that size's bucket. If after is not there,
+       *    the first skip files of the bucket are skipped instead.
+       */
+      FileCursor(const Node* root, size_t min, size_t max, bool reverse, size_t from, size_t skip, File* after);
+
+      /**
+       * @brief Pushes the Nodes within bounds on the path from t toward the next size to be walked
+       */
+      void descend(const Node* t);
+
+      /**
+       * @brief Moves current_ to the next bucket in range, or to nullptr if there is none
+       */
+      void advance();
 };
 
 
@@ -38,6 +134,102 @@ class FileAVL {
     */
    std::vector<File*> query(size_t min, size_t max);
 
+   /**
+    * @brief Answers several range queries in one ordered traversal of the tree
+    * 
+    * @param ranges The [min, max] ranges to query, in any order, and possibly overlapping
+    * @return One vector per range, in the order the ranges were given, each holding what query(min, max) would return
+    * @note Bounds are swapped as in query. Each Node in any range is visited once, and subtrees in the gaps between
+    *    ranges are skipped.
+    */
+   std::vector<std::vector<File*>> queryMany(const std::vector<std::pair<size_t, size_t>>& ranges) const;
+
+   /**
+    * @brief Takes an immutable snapshot of the tree in a cache-friendly array layout, for read-heavy range queries
+    * @see FrozenFileAVL
+    */
+   FrozenFileAVL freeze() const;
+
+   // =========== CURSORS  ===========
+
+   /**
+    * @brief Walks the files whose sizes are within [min, max] lazily, in ascending order of size (descending if reverse)
+    * 
+    * @param min The min value of the file size query range.
+    * @param max The max value of the file size query range.
+    * @param reverse Whether to return the largest files first
+    * @return A cursor positioned before the first file. Within a bucket, files come in insertion order (reversed if reverse).
+    * @note As with query, if min >= max the interval [max, min] is walked
+    */
+   FileCursor cursor(size_t min, size_t max, bool reverse = false) const;
+
+   /**
+    * @brief Continues a walk from a token taken from an earlier cursor
+    * 
+    * @param token The place to continue from, carrying the range and direction of the original walk
+    * @return A cursor positioned before the first file not yet returned
+    */
+   FileCursor resume(const PageToken& token) const;
+
+   /**
+    * @brief Calls visitor on each file whose size is within [min, max], in the order cursor() returns them
+    * 
+    * @param visitor Called with each File*, returning false to stop the walk early
+    * @param reverse Whether to visit the largest files first
+    * @return The number of files visited
+    */
+   template <typename Visitor>
+   size_t visit(size_t min, size_t max, Visitor visitor, bool reverse = false) const {
+      FileCursor walk = cursor(min, max, reverse);
+      size_t visited = 0;
+      while (File* file = walk.next()) {
+         visited++;
+         if (!visitor(file)) {
+            break;
+         }
+      }
+      return visited;
+   }
+
+   // =========== ORDER STATISTICS  ===========
+
+   /**
+    * @brief Counts the files whose sizes are within [min, max] without collecting them
+    * 
+    * @param min The min value of the file size query range.
+    * @param max The max value of the file size query range.
+    * @return The number of files query(min, max) would return
+    * @note As with query, if min >= max the interval [max, min] is counted. Runs in O(log n).
+    */
+   size_t countInRange(size_t min, size_t max) const;
+
+   /**
+    * @brief Totals the sizes of the files whose sizes are within [min, max] without collecting them
+    * 
+    * @param min The min value of the file size query range.
+    * @param max The max value of the file size query range.
+    * @return The sum of getSize() over the files query(min, max) would return
+    * @note As with query, if min >= max the interval [max, min] is totalled. Runs in O(log n).
+    */
+   size_t bytesInRange(size_t min, size_t max) const;
+
+   /**
+    * @brief Finds the file at a given position of the in-order listing query(0, SIZE_MAX) would return
+    * 
+    * @param k The 0-based position of the file
+    * @return The k-th smallest file, or nullptr if k >= size(). Runs in O(log n).
+    */
+   File* kthSmallest(size_t k) const;
+
+   /**
+    * @brief Counts the files strictly smaller than a given size
+    * 
+    * @param size The size to rank
+    * @return The position at which the first file of at least the given size appears, so that
+    *    kthSmallest(rankOf(size)) is that file. Runs in O(log n).
+    */
+   size_t rankOf(size_t size) const;
+
    /**
     * @brief Default Constructor: Construct a new AVLtree object
     */
@@ -58,6 +250,35 @@ class FileAVL {
     * @post Increases the size of the tree by 1
     */
    void insert(File* target);   
+
+   /**
+    * @brief Replaces the contents of the tree with the given files, building a perfectly balanced tree bottom-up
+    *    Files of equal size share a Node, in the order they were given (as if inserted one by one)
+    * 
+    * @param files The files to index
+    * @param presorted If true, files must already be in non-decreasing order of size and the sort is skipped
+    * @post Runs in O(n) after the O(n log n) sort, calling getSize() once per file
+    */
+   void build(std::vector<File*> files, bool presorted = false);
+
+   /**
+    * @brief Removes a file from the AVL tree while maintaining balance
+    *    Its Node is dropped once no other file of the same size remains in it
+    * 
+    * @param target The file to be removed, looked up by its current size
+    * @return True if the file was found and removed. False otherwise.
+    * @post If removed, decreases the size of the tree by 1
+    */
+   bool remove(File* target);
+
+   /**
+    * @brief Moves a file to the Node matching its current size after its contents changed
+    * 
+    * @param target A file already in the tree
+    * @param old_size The size target had when it was inserted (or last updated)
+    * @return True if the file was found under old_size. False otherwise, in which case the tree is unchanged.
+    */
+   bool updateSize(File* target, size_t old_size);
    
    /**
     * @brief Determines the height of a given Node 
@@ -65,7 +286,7 @@ class FileAVL {
     * @param n A pointer to a node to be examined
     * @return The height of the given node, or -1 if given a nullptr
     */
-   int height(Node* n) const;
+   int height(const Node* n) const;
 
    /**
     * @brief Prints level-order traversal of the tree
@@ -82,76 +303,46 @@ class FileAVL {
     */
    int size() const;
 
-   private:
-      static const int ALLOWED_IMBALANCE = 1;
-      Node* root_;
-      int size_;
-
-      /**
-       * @brief Internal routine to insert into a subtree
-       * 
-       * @param target The value to insert
-       * @param subroot The root of the subtree to be inserted into
-       * @post Set the new root of the subtree
-       */
-      void insert(File*& target, Node*& subroot);
-
-      /**
-       * @brief Balance the given Node
-       * 
-       * @param t The Node to be balanced
-       */
-      void balance(Node* &t);
-
-      /**
-       * @brief Prints the level-order traversal of the specified subtree 
-       */
-      void displayLevelOrder(Node* t) const;
-
-     /**
-     * @brief Helper for printInorder(). Prints the unique file sizes in-order given a specified root
-     * @param root The root of the tree to be printed
-     */
-      void displayInOrder(Node* t) const;
+   /**
+    * @brief Returns a sketch of the sizes of the files in the tree, kept current by every insert, removal and bulk load
+    * @see SizeSketch for its quantile and CDF queries and their error
+    */
+   const SizeSketch& sizeSketch() const;
 
-      // =========== ROTATIONS  ===========
+   private:
+      FileSizeTree index_;   // Holds the Nodes, and does the inserting, removing and balancing
+      SizeSketch sketch_;
 
-      /**
-       * @brief Rotates a Node with its left child
-       * 
-       * @param k2 The parent Node to be rotated
-       * @post Updates heights and sets new root
-       */
-      void rotateWithLeftChild(Node*& k2);
+      // The state of a queryMany() traversal, defined in FileAVL.cpp
+      struct RangeSweep;
 
       /**
-       * @brief Rotates a Node with its right child
+       * @brief Internal routine of queryMany(): walks the subtree in-order, skipping it if no range overlaps its sizes
        * 
-       * @param k2 The parent Node to be rotated
-       * @post Updates heights and sets new root
+       * @param t The root of the subtree
+       * @param lo The smallest size the subtree can hold
+       * @param hi The largest size the subtree can hold
+       * @param sweep The ranges, and the results collected so far
        */
-      void rotateWithRightChild(Node*& k1);
+      void queryMany(const Node* t, size_t lo, size_t hi, RangeSweep& sweep) const;
 
       /**
-       * @brief Performs a double rotation to fix a left-right imbalance about k3
+       * @brief Counts and totals the files smaller than key (or no larger than it, if inclusive)
        * 
-       * @param k3 The parent Node with a left-right imbalance
-       * @post Updates heights, sets new root
+       * @param key The size to compare against
+       * @param inclusive Whether files of exactly key are included
+       * @param count Set to the number of such files
+       * @param bytes Set to the total size of such files
        */
-      void doubleWithLeftChlid(Node*& k3);
+      void countBelow(size_t key, bool inclusive, size_t& count, size_t& bytes) const;
 
       /**
-       * @brief Performs a double rotation to fix a right-left imbalance about k3
-       * 
-       * @param k3 The parent Node with a right-left imbalance
-       * @post Updates heights, sets new root
+       * @brief Adds the buckets of the subtree to the sketch, one call per distinct size
        */
-      void doubleWithRightChild(Node*& k3);
+      void sketchBuckets(const Node* t);
 
       /**
-       * @brief Destroys the given Node and its children
-       * 
-       * @param t The node to be deleted
+       * @brief Appends the sizes and files of the subtree in-order, recording where each bucket starts
        */
-      void deleteTree(Node*& t);
-};
+      void flatten(const Node* t, std::vector<size_t>& sizes, std::vector<size_t>& offsets, std::vector<File*>& files) const;
+};
\ No newline at end of file
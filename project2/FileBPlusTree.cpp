@@ -0,0 +1,230 @@
+#include "FileBPlusTree.hpp"
+#include <queue>
+#include <utility>
+
+/**
+ * @brief Default Constructor: Construct a new, empty FileBPlusTree
+ */
+FileBPlusTree::FileBPlusTree() : root_{new BPlusLeaf()}, levels_{0}, size_{0} {}
+
+/**
+ * @brief Destroy the tree, deallocating all Nodes
+ */
+FileBPlusTree::~FileBPlusTree() {
+    deleteTree(root_, levels_);
+}
+
+/**
+ * @brief Destroys the given Node and its children
+ */
+void FileBPlusTree::deleteTree(BPlusNode* t, int level) {
+    if (level == 0) {
+        delete static_cast<BPlusLeaf*>(t);
+        return;
+    }
+    BPlusInner* inner = static_cast<BPlusInner*>(t);
+    for (int i = 0; i <= inner->count_; i++) {
+        deleteTree(inner->children_[i], level - 1);
+    }
+    delete inner;
+}
+
+/**
+ * @brief Returns the number of files in the tree
+ */
+int FileBPlusTree::size() const {
+    return size_;
+}
+
+/**
+ * @brief Retrieves all files in the tree whose file sizes are within [min, max]
+ *
+ * @param min The min value of the file size query range.
+ * @param max The max value of the file size query range.
+ * @return std::vector<File*> storing pointers to all files in the tree within the given range.
+ * @note If the query interval is in descending order (ie. the given parameters min >= max),
+         the interval from [max, min] is searched (since max >= min)
+ */
+std::vector<File*> FileBPlusTree::query(size_t min, size_t max) {
+    if (min > max) {
+        std::swap(min, max);
+    }
+
+    // descend to the leaf where min would be: sizes equal to a separator live to its right
+    BPlusNode* t = root_;
+    for (int level = levels_; level > 0; level--) {
+        BPlusInner* inner = static_cast<BPlusInner*>(t);
+        t = inner->children_[inner->rank(min, true)];
+    }
+
+    std::vector<File*> result;
+    BPlusLeaf* leaf = static_cast<BPlusLeaf*>(t);
+    for (int i = leaf->rank(min, false); leaf != nullptr; leaf = leaf->next_, i = 0) {
+        for (; i < leaf->count_; i++) {
+            if (leaf->keys_[i] > max) {
+                return result;
+            }
+            result.insert(result.end(), leaf->buckets_[i].begin(), leaf->buckets_[i].end());
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Inserts a file, splitting full Nodes on the way back up
+ *    Files of equal size share a bucket, in insertion order
+ *
+ * @param target The file to be inserted
+ * @post Increases the size of the tree by 1
+ */
+void FileBPlusTree::insert(File* target) {
+    size_t separator;
+    BPlusNode* sibling = insert(root_, levels_, target, target->getSize(), separator);
+    if (sibling != nullptr) {
+        // the root was split, so the tree grows a level
+        BPlusInner* root = new BPlusInner();
+        root->count_ = 1;
+        root->keys_[0] = separator;
+        root->children_[0] = root_;
+        root->children_[1] = sibling;
+        root_ = root;
+        levels_++;
+    }
+    size_++;
+}
+
+/**
+ * @brief Internal routine to insert into a subtree
+ *
+ * @param t The root of the subtree
+ * @param level The number of inner levels at and below t
+ * @param target The file to insert
+ * @param size The size of target
+ * @param separator Set to the smallest size of the new right sibling, if t was split
+ * @return The new right sibling of t if t was split, nullptr otherwise
+ */
+BPlusNode* FileBPlusTree::insert(BPlusNode* t, int level, File* target, size_t size, size_t& separator) {
+    if (level == 0) {
+        BPlusLeaf* leaf = static_cast<BPlusLeaf*>(t);
+        int i = leaf->rank(size, false);
+        if (i < leaf->count_ && leaf->keys_[i] == size) {
+            leaf->buckets_[i].push_back(target);
+            return nullptr;
+        }
+        for (int j = leaf->count_; j > i; j--) {
+            leaf->keys_[j] = leaf->keys_[j - 1];
+            leaf->buckets_[j] = std::move(leaf->buckets_[j - 1]);
+        }
+        leaf->keys_[i] = size;
+        leaf->buckets_[i].assign(1, target);
+        leaf->count_++;
+        return leaf->count_ > BPlusNode::CAPACITY ? split(leaf, separator) : nullptr;
+    }
+
+    BPlusInner* inner = static_cast<BPlusInner*>(t);
+    int i = inner->rank(size, true);
+    size_t lifted;
+    BPlusNode* child = insert(inner->children_[i], level - 1, target, size, lifted);
+    if (child == nullptr) {
+        return nullptr;
+    }
+    // the new child goes just right of the one that split
+    for (int j = inner->count_; j > i; j--) {
+        inner->keys_[j] = inner->keys_[j - 1];
+        inner->children_[j + 1] = inner->children_[j];
+    }
+    inner->keys_[i] = lifted;
+    inner->children_[i + 1] = child;
+    inner->count_++;
+    return inner->count_ > BPlusNode::CAPACITY ? split(inner, separator) : nullptr;
+}
+
+/**
+ * @brief Moves the upper half of an overfull leaf into a new leaf
+ *
+ * @param separator Set to the smallest size of the new leaf
+ * @return The new leaf, linked after t
+ */
+BPlusLeaf* FileBPlusTree::split(BPlusLeaf* t, size_t& separator) {
+    BPlusLeaf* right = new BPlusLeaf();
+    int keep = t->count_ / 2;
+    for (int i = keep; i < t->count_; i++) {
+        right->keys_[i - keep] = t->keys_[i];
+        right->buckets_[i - keep] = std::move(t->buckets_[i]);
+        // release the moved-from storage, rather than leave spare capacity in the unused slot
+        std::vector<File*>().swap(t->buckets_[i]);
+    }
+    right->count_ = t->count_ - keep;
+    t->count_ = keep;
+    right->next_ = t->next_;
+    t->next_ = right;
+    separator = right->keys_[0];
+    return right;
+}
+
+/**
+ * @brief Moves the upper half of an overfull inner Node into a new one, lifting out the middle key
+ *
+ * @param separator Set to the key that now separates t from the new Node
+ * @return The new inner Node
+ */
+BPlusInner* FileBPlusTree::split(BPlusInner* t, size_t& separator) {
+    BPlusInner* right = new BPlusInner();
+    int middle = t->count_ / 2;
+    separator = t->keys_[middle];
+    for (int i = middle + 1; i < t->count_; i++) {
+        right->keys_[i - middle - 1] = t->keys_[i];
+    }
+    for (int i = middle + 1; i <= t->count_; i++) {
+        right->children_[i - middle - 1] = t->children_[i];
+    }
+    right->count_ = t->count_ - middle - 1;
+    t->count_ = middle;
+    return right;
+}
+
+/**
+ * @brief Prints the sizes of each Node, level by level, one line per level
+ */
+void FileBPlusTree::displayLevelOrder() const {
+    std::queue<BPlusNode*> current, next;
+    current.push(root_);
+
+    for (int level = levels_; level >= 0; level--) {
+        while (!current.empty()) {
+            BPlusNode* front = current.front();
+            std::cout << "[";
+            for (int i = 0; i < front->count_; i++) {
+                std::cout << (i ? " " : "") << front->keys_[i];
+            }
+            std::cout << "] ";
+            if (level > 0) {
+                BPlusInner* inner = static_cast<BPlusInner*>(front);
+                for (int i = 0; i <= inner->count_; i++) {
+                    next.push(inner->children_[i]);
+                }
+            }
+            current.pop();
+        }
+        std::cout << std::endl;
+        current = std::move(next);
+    }
+}
+
+/**
+ * @brief Prints the unique file sizes of the tree in-order
+ */
+void FileBPlusTree::displayInOrder() const {
+    if (size_ == 0) { return; }
+
+    BPlusNode* t = root_;
+    for (int level = levels_; level > 0; level--) {
+        t = static_cast<BPlusInner*>(t)->children_[0];
+    }
+    for (BPlusLeaf* leaf = static_cast<BPlusLeaf*>(t); leaf != nullptr; leaf = leaf->next_) {
+        for (int i = 0; i < leaf->count_; i++) {
+            std::cout << leaf->keys_[i] << " ";
+        }
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file FileBPlusTree.hpp
+ * @brief Defines a B+-tree index of files by size, with the same interface as FileAVL
+ */
+
+#pragma once
+#include <vector>
+#include <iostream>
+
+#include "File.hpp"
+
+/**
+ * @brief The part shared by inner Nodes and leaves: sizes packed contiguously, so a Node is searched in a few cache lines
+ *    Arrays hold one more than CAPACITY so a Node can overflow briefly before it is split.
+ */
+struct BPlusNode {
+   static const int CAPACITY = 32;   // The most sizes a Node holds
+
+   int count_;                       // The number of sizes in use
+   size_t keys_[CAPACITY + 1];
+
+   BPlusNode() : count_{0} {}
+
+   /**
+    * @brief Returns the number of keys below size (or no larger than size, if inclusive), without branching on each key
+    */
+   int rank(size_t size, bool inclusive) const {
+      int rank = 0;
+      for (int i = 0; i < count_; i++) {
+         rank += inclusive ? keys_[i] <= size : keys_[i] < size;
+      }
+      return rank;
+   }
+};
+
+/**
+ * @brief An inner Node: children_[i] holds the sizes below keys_[i], and children_[count_] the rest
+ */
+struct BPlusInner : BPlusNode {
+   BPlusNode* children_[CAPACITY + 2];
+};
+
+/**
+ * @brief A leaf: keys_[i] is a distinct size, and buckets_[i] the files of that size in insertion order
+ */
+struct BPlusLeaf : BPlusNode {
+   std::vector<File*> buckets_[CAPACITY + 1];
+   BPlusLeaf* next_;                 // The leaf holding the next larger sizes, so range scans never climb back up
+
+   BPlusLeaf() : next_{nullptr} {}
+};
+
+/**
+ * @brief An index of files by size, stored as a B+-tree of wide Nodes instead of FileAVL's binary ones
+ * Each level costs one Node's worth of contiguous keys rather than one pointer chase per comparison, and the tree is
+ *    about log_32(n) levels deep. Leaves are linked in order of size, so a query descends once and then scans.
+ * Offers the same insert, query, size and display operations as FileAVL, so either can be used.
+ */
+class FileBPlusTree {
+   public:
+      /**
+       * @brief Retrieves all files in the tree whose file sizes are within [min, max]
+       *
+       * @param min The min value of the file size query range.
+       * @param max The max value of the file size query range.
+       * @return std::vector<File*> storing pointers to all files in the tree within the given range.
+       * @note If the query interval is in descending order (ie. the given parameters min >= max),
+               the interval from [max, min] is searched (since max >= min)
+       */
+      std::vector<File*> query(size_t min, size_t max);
+
+      /**
+       * @brief Default Constructor: Construct a new, empty FileBPlusTree
+       */
+      FileBPlusTree();
+
+      /**
+       * @brief Destroy the tree, deallocating all Nodes
+       */
+      ~FileBPlusTree();
+
+      FileBPlusTree(const FileBPlusTree&) = delete;
+      FileBPlusTree& operator=(const FileBPlusTree&) = delete;
+
+      /**
+       * @brief Inserts a file, splitting full Nodes on the way back up
+       *    Files of equal size share a bucket, in insertion order
+       *
+       * @param target The file to be inserted
+       * @post Increases the size of the tree by 1
+       */
+      void insert(File* target);
+
+      /**
+       * @brief Prints the sizes of each Node, level by level, one line per level
+       */
+      void displayLevelOrder() const;
+
+      /**
+       * @brief Prints the unique file sizes of the tree in-order
+       */
+      void displayInOrder() const;
+
+      /**
+       * @brief Returns the number of files in the tree
+       */
+      int size() const;
+
+   private:
+      BPlusNode* root_;
+      int levels_;   // The number of inner levels above the leaves, 0 when the root is a leaf
+      int size_;
+
+      /**
+       * @brief Internal routine to insert into a subtree
+       *
+       * @param t The root of the subtree
+       * @param level The number of inner levels at and below t
+       * @param target The file to insert
+       * @param size The size of target
+       * @param separator Set to the smallest size of the new right sibling, if t was split
+       * @return The new right sibling of t if t was split, nullptr otherwise
+       */
+      BPlusNode* insert(BPlusNode* t, int level, File* target, size_t size, size_t& separator);
+
+      /**
+       * @brief Moves the upper half of an overfull leaf into a new leaf
+       *
+       * @param separator Set to the smallest size of the new leaf
+       * @return The new leaf, linked after t
+       */
+      BPlusLeaf* split(BPlusLeaf* t, size_t& separator);
+
+      /**
+       * @brief Moves the upper half of an overfull inner Node into a new one, lifting out the middle key
+       *
+       * @param separator Set to the key that now separates t from the new Node
+       * @return The new inner Node
+       */
+      BPlusInner* split(BPlusInner* t, size_t& separator);
+
+      /**
+       * @brief Destroys the given Node and its children
+       */
+      void deleteTree(BPlusNode* t, int level);
+};
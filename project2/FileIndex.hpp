@@ -0,0 +1,683 @@
+/**
+ * @file FileIndex.hpp
+ * @brief Defines FileIndex, an AVL tree of files ordered by any key extracted from them, and the standard key extractors
+ *    FileAVL is the size index, augmented with subtree counts and byte totals.
+ */
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <string_view>
+
+#include "File.hpp"
+
+// =========== KEY EXTRACTORS  ===========
+// Each extractor names its key type as `type` and computes it from a File. The key is computed once per insert and
+//    cached in the Node, so lookups and rebalancing never go back to the files.
+
+/**
+ * @brief Keys a file by its size in bytes, as FileAVL does
+ */
+struct SizeKey {
+   using type = size_t;
+   size_t operator()(const File* f) const { return f->getSize(); }
+};
+
+/**
+ * @brief Keys a file by the length of its name, extension included
+ */
+struct NameLengthKey {
+   using type = size_t;
+   size_t operator()(const File* f) const { return f->getNameView().size(); }
+};
+
+/**
+ * @brief Keys a file by its extension (without the period), copied so the key outlives changes to the file
+ */
+struct ExtensionKey {
+   using type = std::string;
+   std::string operator()(const File* f) const { return std::string(f->getFileName().extension()); }
+};
+
+/**
+ * @brief Keys a file by a hash of its icon's pixels, so files with identical icons share a Node. Files without an icon hash to 0.
+ */
+struct IconKey {
+   using type = size_t;
+   static const size_t ICON_DIM = 256;   // The length of an icon array, as in File
+
+   size_t operator()(const File* f) const {
+      const int* icon = f->getIcon();
+      if (icon == nullptr) {
+         return 0;
+      }
+      return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(icon), ICON_DIM * sizeof(int)));
+   }
+};
+
+// =========== AUGMENTATIONS  ===========
+// An augmentation adds its Fields to every Node, and update() recomputes them from the Node's files and children.
+//    The index calls update() on every Node whose files or children changed, children first, after its height.
+
+/**
+ * @brief Adds nothing to the Nodes, for indices that only look files up
+ */
+struct NoAugment {
+   struct Fields {};
+
+   template <typename Node>
+   static void update(Node*) {}
+};
+
+/**
+ * @brief An AVL tree of files ordered by the key KeyExtractor computes, compared with Compare
+ *    Files with equivalent keys share a Node, in insertion order.
+ * The extractor and comparator are template parameters, so each index is compiled for its key type with the
+ *    comparisons inlined, and a new index only needs a new extractor. Augment keeps per-subtree totals in each
+ *    Node, for order statistics (see SizeTotals in FileAVL.hpp).
+ * @note A file's key is read when it is inserted. If a file changes in a way that changes its key, remove it
+ *    beforehand and insert it again afterwards, or remove it under its old key.
+ */
+template <typename KeyExtractor, typename Compare = std::less<typename KeyExtractor::type>, typename Augment = NoAugment>
+class FileIndex {
+   public:
+      using Key = typename KeyExtractor::type;
+
+      struct IndexNode : Augment::Fields {
+         Key key_;                    // The key shared by every file in the Node
+         std::vector<File*> files_;
+         int height_;                 // The height of the Node
+         IndexNode* left_;            // A pointer to Node's left child
+         IndexNode* right_;           // A pointer to Node's right child
+
+         IndexNode(Key key, File* f) : Augment::Fields{}, key_{std::move(key)}, files_{ {f} }, height_{0}, left_{nullptr}, right_{nullptr} {}
+      };
+
+      /**
+       * @brief Default Constructor: Construct a new, empty FileIndex
+       */
+      FileIndex(KeyExtractor extract = KeyExtractor(), Compare compare = Compare());
+
+      /**
+       * @brief Destroy the FileIndex, deallocating all Nodes
+       */
+      ~FileIndex();
+
+      FileIndex(const FileIndex&) = delete;
+      FileIndex& operator=(const FileIndex&) = delete;
+
+      /**
+       * @brief Retrieves all files whose keys are within [min, max]
+       *
+       * @param min The min value of the key query range.
+       * @param max The max value of the key query range.
+       * @return std::vector<File*> storing pointers to all files within the given range, in key order
+       * @note If the query interval is in descending order (ie. max precedes min), the interval [max, min] is searched
+       */
+      std::vector<File*> query(const Key& min, const Key& max) const;
+
+      /**
+       * @brief Retrieves all files whose key is equivalent to key, in insertion order
+       */
+      std::vector<File*> find(const Key& key) const;
+
+      /**
+       * @brief Returns the Node holding the files whose key is equivalent to key, or nullptr if there is none
+       */
+      const IndexNode* node(const Key& key) const;
+
+      /**
+       * @brief Returns the root Node, or nullptr if the index is empty, for walks the index does not provide
+       */
+      const IndexNode* root() const;
+
+      /**
+       * @brief Inserts a file while maintaining balance
+       *
+       * @param target The file to be inserted
+       * @post Increases the size of the index by 1
+       */
+      void insert(File* target);
+
+      /**
+       * @brief Inserts a file under a key the caller already extracted, while maintaining balance
+       *
+       * @param target The file to be inserted
+       * @param key The key of target
+       * @post Increases the size of the index by 1
+       */
+      void insert(File* target, Key key);
+
+      /**
+       * @brief Replaces the contents of the index with the given files, building a perfectly balanced tree bottom-up
+       *    Files with equivalent keys share a Node, in the order they were given (as if inserted one by one)
+       *
+       * @param files The files to index
+       * @param presorted If true, files must already be in key order and the sort is skipped
+       * @post Runs in O(n) after the O(n log n) sort, extracting each key once
+       */
+      void build(std::vector<File*> files, bool presorted = false);
+
+      /**
+       * @brief Removes a file while maintaining balance. Its Node is dropped once no other file remains in it.
+       *
+       * @param target The file to be removed, looked up by its current key
+       * @return True if the file was found and removed. False otherwise.
+       * @post If removed, decreases the size of the index by 1
+       */
+      bool remove(File* target);
+
+      /**
+       * @brief Removes a file filed under the given key (such as the key it had before it changed), while maintaining balance
+       *
+       * @param target The file to be removed
+       * @param key The key target was inserted under
+       * @return True if the file was found and removed. False otherwise.
+       * @post If removed, decreases the size of the index by 1
+       */
+      bool remove(File* target, const Key& key);
+
+      /**
+       * @brief Returns the number of files in the index
+       */
+      int size() const;
+
+      /**
+       * @brief Determines the height of a given Node, or -1 if given a nullptr
+       */
+      int height(const IndexNode* n) const;
+
+      /**
+       * @brief Prints the keys of the index level by level, one line per level
+       */
+      void displayLevelOrder() const;
+
+      /**
+       * @brief Prints the unique keys of the index in-order
+       */
+      void displayInOrder() const;
+
+   private:
+      static const int ALLOWED_IMBALANCE = 1;
+      IndexNode* root_;
+      int size_;
+      KeyExtractor extract_;
+      Compare compare_;
+
+      /**
+       * @brief Internal routine to insert into a subtree
+       */
+      void insert(File* target, Key&& key, IndexNode*& subroot);
+
+      /**
+       * @brief Internal routine to remove from a subtree
+       * @return True if target was found and removed
+       */
+      bool remove(File* target, const Key& key, IndexNode*& subroot);
+
+      /**
+       * @brief Unlinks the Node holding the smallest key of a non-empty subtree, rebalancing on the way back up
+       */
+      IndexNode* detachMin(IndexNode*& subroot);
+
+      /**
+       * @brief Appends the files of the subtree whose keys are within [min, max], in order
+       */
+      void query(const IndexNode* t, const Key& min, const Key& max, std::vector<File*>& result) const;
+
+      /**
+       * @brief Prints the keys of the subtree in-order
+       */
+      void displayInOrder(const IndexNode* t) const;
+
+      /**
+       * @brief Links nodes[begin, end) into a perfectly balanced subtree, rooted at the middle Node
+       * @return The root of the subtree, or nullptr if the range is empty
+       */
+      IndexNode* linkBalanced(const std::vector<IndexNode*>& nodes, size_t begin, size_t end);
+
+      /**
+       * @brief Recomputes the height and augmentation of a Node from its files and children
+       */
+      void update(IndexNode* t);
+
+      /**
+       * @brief Balance the given Node
+       */
+      void balance(IndexNode*& t);
+
+      /**
+       * @brief Rotates a Node with its left child
+       */
+      void rotateWithLeftChild(IndexNode*& k2);
+
+      /**
+       * @brief Rotates a Node with its right child
+       */
+      void rotateWithRightChild(IndexNode*& k1);
+
+      /**
+       * @brief Destroys the given Node and its children
+       */
+      void deleteTree(IndexNode*& t);
+};
+
+// The indices this project uses
+using FileSizeIndex = FileIndex<SizeKey>;
+using FileNameLengthIndex = FileIndex<NameLengthKey>;
+using FileExtensionIndex = FileIndex<ExtensionKey>;
+using FileIconIndex = FileIndex<IconKey>;
+
+/**
+ * @brief Default Constructor: Construct a new, empty FileIndex
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+FileIndex<KeyExtractor, Compare, Augment>::FileIndex(KeyExtractor extract, Compare compare)
+    : root_{nullptr}, size_{0}, extract_{extract}, compare_{compare} {}
+
+/**
+ * @brief Destroy the FileIndex, deallocating all Nodes
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+FileIndex<KeyExtractor, Compare, Augment>::~FileIndex() {
+   deleteTree(root_);
+}
+
+/**
+ * @brief Destroys the given Node and its children
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::deleteTree(IndexNode*& t) {
+   if (t == nullptr) { return; }
+   deleteTree(t->left_);
+   deleteTree(t->right_);
+   delete t;
+   t = nullptr;
+}
+
+/**
+ * @brief Returns the number of files in the index
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+int FileIndex<KeyExtractor, Compare, Augment>::size() const {
+   return size_;
+}
+
+/**
+ * @brief Determines the height of a given Node, or -1 if given a nullptr
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+int FileIndex<KeyExtractor, Compare, Augment>::height(const IndexNode* n) const {
+   return n == nullptr ? -1 : n->height_;
+}
+
+/**
+ * @brief Retrieves all files whose keys are within [min, max]
+ *
+ * @param min The min value of the key query range.
+ * @param max The max value of the key query range.
+ * @return std::vector<File*> storing pointers to all files within the given range, in key order
+ * @note If the query interval is in descending order (ie. max precedes min), the interval [max, min] is searched
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+std::vector<File*> FileIndex<KeyExtractor, Compare, Augment>::query(const Key& min, const Key& max) const {
+   std::vector<File*> result;
+   if (compare_(max, min)) {
+      query(root_, max, min, result);
+   } else {
+      query(root_, min, max, result);
+   }
+   return result;
+}
+
+/**
+ * @brief Appends the files of the subtree whose keys are within [min, max], in order
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::query(const IndexNode* t, const Key& min, const Key& max, std::vector<File*>& result) const {
+   if (t == nullptr) {
+      return;
+   }
+   bool aboveMin = !compare_(t->key_, min);
+   bool belowMax = !compare_(max, t->key_);
+   if (aboveMin) {
+      query(t->left_, min, max, result);
+   }
+   if (aboveMin && belowMax) {
+      result.insert(result.end(), t->files_.begin(), t->files_.end());
+   }
+   if (belowMax) {
+      query(t->right_, min, max, result);
+   }
+}
+
+/**
+ * @brief Retrieves all files whose key is equivalent to key, in insertion order
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+std::vector<File*> FileIndex<KeyExtractor, Compare, Augment>::find(const Key& key) const {
+   const IndexNode* found = node(key);
+   return found != nullptr ? found->files_ : std::vector<File*>();
+}
+
+/**
+ * @brief Returns the Node holding the files whose key is equivalent to key, or nullptr if there is none
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+const typename FileIndex<KeyExtractor, Compare, Augment>::IndexNode* FileIndex<KeyExtractor, Compare, Augment>::node(const Key& key) const {
+   const IndexNode* current = root_;
+   while (current != nullptr) {
+      if (compare_(key, current->key_)) {
+         current = current->left_;
+      } else if (compare_(current->key_, key)) {
+         current = current->right_;
+      } else {
+         return current;
+      }
+   }
+   return nullptr;
+}
+
+/**
+ * @brief Returns the root Node, or nullptr if the index is empty, for walks the index does not provide
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+const typename FileIndex<KeyExtractor, Compare, Augment>::IndexNode* FileIndex<KeyExtractor, Compare, Augment>::root() const {
+   return root_;
+}
+
+/**
+ * @brief Inserts a file while maintaining balance
+ *
+ * @param target The file to be inserted
+ * @post Increases the size of the index by 1
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::insert(File* target) {
+   insert(target, extract_(target));
+}
+
+/**
+ * @brief Inserts a file under a key the caller already extracted, while maintaining balance
+ *
+ * @param target The file to be inserted
+ * @param key The key of target
+ * @post Increases the size of the index by 1
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::insert(File* target, Key key) {
+   insert(target, std::move(key), root_);
+   size_++;
+}
+
+/**
+ * @brief Internal routine to insert into a subtree
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::insert(File* target, Key&& key, IndexNode*& subroot) {
+   if (subroot == nullptr) {
+      subroot = new IndexNode(std::move(key), target);
+   } else if (compare_(key, subroot->key_)) {
+      insert(target, std::move(key), subroot->left_);
+   } else if (compare_(subroot->key_, key)) {
+      insert(target, std::move(key), subroot->right_);
+   } else {
+      subroot->files_.push_back(target);
+   }
+
+   balance(subroot);
+}
+
+/**
+ * @brief Replaces the contents of the index with the given files, building a perfectly balanced tree bottom-up
+ *    Files with equivalent keys share a Node, in the order they were given (as if inserted one by one)
+ *
+ * @param files The files to index
+ * @param presorted If true, files must already be in key order and the sort is skipped
+ * @post Runs in O(n) after the O(n log n) sort, extracting each key once
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::build(std::vector<File*> files, bool presorted) {
+   deleteTree(root_);
+   size_ = static_cast<int>(files.size());
+
+   // extract every key once up front instead of on each comparison
+   std::vector<std::pair<Key, File*>> keyed;
+   keyed.reserve(files.size());
+   for (File* file : files) {
+      keyed.emplace_back(extract_(file), file);
+   }
+   if (!presorted) {
+      // stable, so each Node keeps the order the files were given in
+      std::stable_sort(keyed.begin(), keyed.end(),
+         [this](const std::pair<Key, File*>& lhs, const std::pair<Key, File*>& rhs) { return compare_(lhs.first, rhs.first); });
+   }
+
+   // one Node per run of equivalent keys
+   std::vector<IndexNode*> nodes;
+   for (std::pair<Key, File*>& entry : keyed) {
+      if (nodes.empty() || compare_(nodes.back()->key_, entry.first)) {
+         nodes.push_back(new IndexNode(std::move(entry.first), entry.second));
+      } else {
+         nodes.back()->files_.push_back(entry.second);
+      }
+   }
+   root_ = linkBalanced(nodes, 0, nodes.size());
+}
+
+/**
+ * @brief Links nodes[begin, end) into a perfectly balanced subtree, rooted at the middle Node
+ * @return The root of the subtree, or nullptr if the range is empty
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+typename FileIndex<KeyExtractor, Compare, Augment>::IndexNode* FileIndex<KeyExtractor, Compare, Augment>::linkBalanced(
+      const std::vector<IndexNode*>& nodes, size_t begin, size_t end) {
+   if (begin == end) {
+      return nullptr;
+   }
+   size_t middle = begin + (end - begin) / 2;
+   IndexNode* subroot = nodes[middle];
+   subroot->left_ = linkBalanced(nodes, begin, middle);
+   subroot->right_ = linkBalanced(nodes, middle + 1, end);
+   // the halves differ by at most one Node, so their heights differ by at most one
+   update(subroot);
+   return subroot;
+}
+
+/**
+ * @brief Removes a file while maintaining balance. Its Node is dropped once no other file remains in it.
+ *
+ * @param target The file to be removed, looked up by its current key
+ * @return True if the file was found and removed. False otherwise.
+ * @post If removed, decreases the size of the index by 1
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+bool FileIndex<KeyExtractor, Compare, Augment>::remove(File* target) {
+   return remove(target, extract_(target));
+}
+
+/**
+ * @brief Removes a file filed under the given key (such as the key it had before it changed), while maintaining balance
+ *
+ * @param target The file to be removed
+ * @param key The key target was inserted under
+ * @return True if the file was found and removed. False otherwise.
+ * @post If removed, decreases the size of the index by 1
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+bool FileIndex<KeyExtractor, Compare, Augment>::remove(File* target, const Key& key) {
+   if (!remove(target, key, root_)) {
+      return false;
+   }
+   size_--;
+   return true;
+}
+
+/**
+ * @brief Internal routine to remove from a subtree
+ * @return True if target was found and removed
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+bool FileIndex<KeyExtractor, Compare, Augment>::remove(File* target, const Key& key, IndexNode*& subroot) {
+   if (subroot == nullptr) {
+      return false;
+   }
+
+   bool removed;
+   if (compare_(key, subroot->key_)) {
+      removed = remove(target, key, subroot->left_);
+   } else if (compare_(subroot->key_, key)) {
+      removed = remove(target, key, subroot->right_);
+   } else {
+      // erase (rather than swap with the back) so the rest of the Node keeps its insertion order
+      std::vector<File*>& files = subroot->files_;
+      auto found = std::find(files.begin(), files.end(), target);
+      if (found == files.end()) {
+         return false;
+      }
+      files.erase(found);
+      if (!files.empty()) {
+         update(subroot);
+         return true;
+      }
+
+      // the Node is empty: replace it by its only child, or by the smallest Node of its right subtree
+      IndexNode* old = subroot;
+      if (old->left_ == nullptr || old->right_ == nullptr) {
+         subroot = (old->left_ != nullptr) ? old->left_ : old->right_;
+      } else {
+         subroot = detachMin(old->right_);
+         subroot->left_ = old->left_;
+         subroot->right_ = old->right_;
+      }
+      delete old;
+      removed = true;
+   }
+
+   if (removed) {
+      balance(subroot);
+   }
+   return removed;
+}
+
+/**
+ * @brief Unlinks the Node holding the smallest key of a non-empty subtree, rebalancing on the way back up
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+typename FileIndex<KeyExtractor, Compare, Augment>::IndexNode* FileIndex<KeyExtractor, Compare, Augment>::detachMin(IndexNode*& subroot) {
+   if (subroot->left_ == nullptr) {
+      IndexNode* min = subroot;
+      subroot = min->right_;
+      return min;
+   }
+   IndexNode* min = detachMin(subroot->left_);
+   balance(subroot);
+   return min;
+}
+
+/**
+ * @brief Balance the given Node
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::balance(IndexNode*& t) {
+   if (t == nullptr) {
+      return;
+   }
+
+   if (height(t->left_) - height(t->right_) > ALLOWED_IMBALANCE) {
+      if (height(t->left_->left_) < height(t->left_->right_)) {
+         rotateWithRightChild(t->left_);
+      }
+      rotateWithLeftChild(t);
+   } else if (height(t->right_) - height(t->left_) > ALLOWED_IMBALANCE) {
+      if (height(t->right_->right_) < height(t->right_->left_)) {
+         rotateWithLeftChild(t->right_);
+      }
+      rotateWithRightChild(t);
+   }
+
+   update(t);
+}
+
+/**
+ * @brief Recomputes the height and augmentation of a Node from its files and children
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::update(IndexNode* t) {
+   t->height_ = std::max(height(t->left_), height(t->right_)) + 1;
+   Augment::update(t);
+}
+
+/**
+ * @brief Rotates a Node with its left child
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::rotateWithLeftChild(IndexNode*& k2) {
+   IndexNode* k1 = k2->left_;
+   k2->left_ = k1->right_;
+   k1->right_ = k2;
+   // k2 is now below k1, so it is updated first
+   update(k2);
+   update(k1);
+   k2 = k1;
+}
+
+/**
+ * @brief Rotates a Node with its right child
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::rotateWithRightChild(IndexNode*& k1) {
+   IndexNode* k2 = k1->right_;
+   k1->right_ = k2->left_;
+   k2->left_ = k1;
+   update(k1);
+   update(k2);
+   k1 = k2;
+}
+
+/**
+ * @brief Prints the keys of the index level by level, one line per level
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::displayLevelOrder() const {
+   if (!root_) { return; }
+
+   std::queue<const IndexNode*> current, next;
+   current.push(root_);
+   while (!current.empty()) {
+      while (!current.empty()) {
+         const IndexNode* front = current.front();
+         if (front->left_) { next.push(front->left_); }
+         if (front->right_) { next.push(front->right_); }
+         std::cout << front->key_ << " ";
+         current.pop();
+      }
+      std::cout << std::endl;
+      current = std::move(next);
+   }
+}
+
+/**
+ * @brief Prints the unique keys of the index in-order
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::displayInOrder() const {
+   if (!root_) { return; }
+   displayInOrder(root_);
+   std::cout << std::endl;
+}
+
+/**
+ * @brief Prints the keys of the subtree in-order
+ */
+template <typename KeyExtractor, typename Compare, typename Augment>
+void FileIndex<KeyExtractor, Compare, Augment>::displayInOrder(const IndexNode* t) const {
+   if (!t) { return; }
+   displayInOrder(t->left_);
+   std::cout << t->key_ << " ";
+   displayInOrder(t->right_);
+}
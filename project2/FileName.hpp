@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief A filename stored inline when it fits in INLINE_CAPACITY bytes, and on the heap otherwise.
+ * Alongside the characters it keeps the position of the extension's period and the name's hash,
+ *    both computed once on construction, so lookups and comparisons never re-scan or copy the name.
+ * The hash is hashOf() of the characters, so it can be compared with the hash of any view.
+ * It takes no more room than the std::string it replaces: the period is kept in the last byte of the inline buffer
+ *    (or beside the heap pointer), and the hash is 32 bits.
+ * @note project1 and project2 each carry this file, byte for byte, since each project is built and handed in from its
+ *    own directory. Change both together.
+ */
+class FileName {
+   public:
+      static const size_t INLINE_CAPACITY = 23;   // Nearly every filename is shorter than this
+      static const size_t NO_EXTENSION = SIZE_MAX;
+
+      /**
+       * @brief Returns the hash a FileName with the given characters has
+       */
+      static uint32_t hashOf(std::string_view characters) {
+         return static_cast<uint32_t>(std::hash<std::string_view>{}(characters));
+      }
+
+   private:
+      struct Spilled {
+         char* characters_;
+         uint32_t period_;
+      };
+
+      // Position of the period, or length_ if there is none, is stored in the last byte of inline_ or in heap_.period_
+      union {
+         char inline_[INLINE_CAPACITY + 1];   // Zero padded past length_, so equal inline names have equal buffers
+         Spilled heap_;
+      };
+      uint32_t length_;
+      uint32_t hash_;
+
+      /**
+       * @brief Returns true if the characters live on the heap
+       */
+      bool spilled() const { return length_ > INLINE_CAPACITY; }
+
+      /**
+       * @brief Returns the position of the period, or length_ if there is none
+       */
+      uint32_t periodAt() const { return spilled() ? heap_.period_ : static_cast<unsigned char>(inline_[INLINE_CAPACITY]); }
+
+      /**
+       * @brief Allocates (if needed) and zero-fills storage for length characters, and records the length
+       * @return The storage to write the characters into
+       */
+      char* allocate(size_t length);
+
+      /**
+       * @brief Computes the period position and hash once the characters are in place
+       */
+      void finish();
+
+      /**
+       * @brief Frees heap storage, if any, leaving the empty name
+       */
+      void reset();
+
+   public:
+      /**
+       * @brief Constructs the empty name (also the state of a moved-from FileName)
+       */
+      FileName();
+
+      /**
+       * @brief Constructs a name holding a copy of the given characters
+       */
+      explicit FileName(std::string_view name);
+
+      /**
+       * @brief Constructs the concatenation of base and suffix, without building a temporary string
+       */
+      FileName(std::string_view base, std::string_view suffix);
+
+      FileName(const FileName& rhs);
+      FileName& operator=(const FileName& rhs);
+      FileName(FileName&& rhs) noexcept;
+      FileName& operator=(FileName&& rhs) noexcept;
+      ~FileName();
+
+      /**
+       * @brief Returns a view of the characters, valid until this FileName is modified or destroyed
+       */
+      std::string_view view() const { return {spilled() ? heap_.characters_ : inline_, length_}; }
+
+      /**
+       * @brief Returns the name as a new std::string
+       */
+      std::string str() const { return std::string(view()); }
+
+      size_t size() const { return length_; }
+      bool empty() const { return length_ == 0; }
+
+      /**
+       * @brief Returns the precomputed hash of the characters
+       */
+      uint32_t hash() const { return hash_; }
+
+      /**
+       * @brief Returns the position of the period, or NO_EXTENSION if the name has none
+       */
+      size_t period() const { return periodAt() == length_ ? NO_EXTENSION : periodAt(); }
+
+      /**
+       * @brief Returns the part of the name before the period (the whole name if there is none)
+       */
+      std::string_view base() const { return view().substr(0, periodAt()); }
+
+      /**
+       * @brief Returns the part of the name after the period (empty if there is none)
+       */
+      std::string_view extension() const { return periodAt() == length_ ? std::string_view() : view().substr(periodAt() + 1); }
+
+      /**
+       * @brief Two names are equal when their characters are. Differing hashes or lengths reject a mismatch without touching the characters.
+       */
+      bool operator==(const FileName& rhs) const;
+      bool operator!=(const FileName& rhs) const { return !(*this == rhs); }
+      bool operator==(std::string_view rhs) const { return view() == rhs; }
+      bool operator!=(std::string_view rhs) const { return view() != rhs; }
+
+      /**
+       * @brief Orders names lexicographically by byte, as std::string does
+       */
+      bool operator<(const FileName& rhs) const { return view() < rhs.view(); }
+};
+
+static_assert(sizeof(FileName) <= sizeof(std::string), "a FileName must be no larger than the std::string it replaces");
@@ -0,0 +1,23 @@
+/**
+ * @file FileSlice.hpp
+ * @brief Defines FileSlice, a view of a contiguous run of File pointers owned by an index
+ */
+
+#pragma once
+#include <cstddef>
+
+#include "File.hpp"
+
+/**
+ * @brief A contiguous run of File pointers within an index, valid until the index that returned it is changed or destroyed
+ */
+struct FileSlice {
+   File* const* begin_ = nullptr;
+   File* const* end_ = nullptr;
+
+   File* const* begin() const { return begin_; }
+   File* const* end() const { return end_; }
+   size_t size() const { return end_ - begin_; }
+   bool empty() const { return begin_ == end_; }
+   File* operator[](size_t i) const { return begin_[i]; }
+};
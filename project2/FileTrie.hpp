@@ -5,39 +5,186 @@
 
 
 #pragma once
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
 #include <cctype>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <functional>
 #include "File.hpp"
+#include "FileSlice.hpp"
+#include "Arena.hpp"
 
-struct FileTrieNode {   
-    char stored;
+// A node of a path-compressed trie: the edge into it carries a whole run of characters, not just one
+// Children are found by the first character of their label, mapped to one of the ALPHABET symbols names can hold.
+//    A node with few children keeps just those, in symbol order, and finds one by counting the bits of `present` below
+//    its symbol. Past SPARSE_LIMIT children it switches to one slot per symbol, indexed directly.
+// Nodes and everything they point to live in the FileTrie's arena, so a node owns nothing and is never destroyed alone.
+struct FileTrieNode {
+    static const int ALPHABET = 37;         // '.', '0'-'9' and 'a'-'z'
+    static const int SPARSE_LIMIT = 8;      // The most children kept packed
 
-    std::unordered_set<File*> matching;
-    std::unordered_map<char, FileTrieNode*> next;
+    uint64_t present;                       // Bit s is set if a child's label starts with symbol s
+    const char* label;                      // The lowercase characters on the edge from the parent. Empty only at the head.
+    File** here;                            // The files whose lowercase name ends exactly at this node, in insertion order
+    FileTrieNode** next;                    // The children in symbol order if packed, or ALPHABET slots (nullptr if empty) if dense
 
-    FileTrieNode(const char& c = ' ', File* to_add = nullptr) : stored{c}, matching{}, next{} {
-        if (to_add) { matching.insert(to_add); }
+    size_t begin;                           // The files under this node are FileTrie::ordered_[begin, begin + total)
+
+    uint32_t length;                        // The number of characters in label
+    uint32_t count;                         // The number of files in here
+    uint32_t capacity;                      // The room in here
+    uint32_t total;                         // The number of files under this node, its own included. Always up to date.
+    uint8_t children;                       // The number of children
+    uint8_t room;                           // The room in next while packed
+    bool dense;
+
+    // Returns the symbol of a lowercase character, or ALPHABET if names cannot hold it
+    static int symbol(char c) {
+        if (c >= 'a' && c <= 'z') { return 11 + (c - 'a'); }
+        if (c >= '0' && c <= '9') { return 1 + (c - '0'); }
+        return c == '.' ? 0 : ALPHABET;
+    }
+
+    // Returns where the child for symbol s is, or would go, in next
+    size_t slot(int s) const {
+        return dense ? size_t(s) : size_t(__builtin_popcountll(present & ((uint64_t(1) << s) - 1)));
+    }
+
+    // Returns the number of entries of next to visit, some of which are nullptr if dense
+    size_t slots() const {
+        return dense ? ALPHABET : children;
+    }
+
+    // Returns the child whose label starts with c, or nullptr
+    FileTrieNode* child(char c) const {
+        int s = symbol(c);
+        if (s == ALPHABET || !(present >> s & 1)) { return nullptr; }
+        return next[slot(s)];
     }
 };
 
+// The bytes a FileTrie holds, by what they hold
+struct FileTrieMemory {
+    size_t nodes;       // The nodes themselves
+    size_t labels;      // The characters of their labels
+    size_t children;    // Their current child arrays
+    size_t files;       // Their current arrays of files
+    size_t wasted;      // Arena bytes in arrays since outgrown, nodes since removed, and alignment padding
+    size_t reserved;    // Arena bytes taken from the heap, so everything above plus what is not handed out yet
+    size_t layout;      // The array of all files in name order, kept outside the arena
+
+    // Returns the bytes the trie holds in total
+    size_t total() const { return reserved + layout; }
+};
+
 class FileTrie {
     private:
+        Arena arena_;
         FileTrieNode* head;
-    
+
+        // Every file, ordered by lowercase name, so the files under any node are one contiguous range.
+        //    Laid out again on the first lookup after a change. Concurrent lookups may both find it stale, so the
+        //    layout is done under layoutMutex_, and dirty_ is cleared (with release) only once it is complete.
+        mutable std::vector<File*> ordered_;
+        mutable std::atomic<bool> dirty_;
+        mutable std::mutex layoutMutex_;
+        size_t count_;
+        size_t nodes_;
+        FileTrieMemory memory_;     // Live bytes by component; wasted, reserved and layout are filled in on request
+
+        // Makes a node in the arena, with a lowercase copy of label
+        FileTrieNode* makeNode(std::string_view label);
+
+        // Adds a child to parent, whose label must start with a character no other child's does
+        void addChild(FileTrieNode* parent, FileTrieNode* n);
+
+        // Adds a file to the files ending at n
+        void addHere(FileTrieNode* n, File* f);
+
+        // Fills ordered_ from the subtree rooted at n, recording where each node's range begins
+        void layout(FileTrieNode* n) const;
+
+        // Lays the files out again if any changed since the last layout. Safe to call from concurrent lookups.
+        void ensureLayout() const;
+
+        // Returns the node whose subtree holds exactly the files starting with prefix, or nullptr if none do
+        FileTrieNode* find(std::string_view prefix) const;
+
+        // Adds delta to the totals of the nodes along the path of name, which must end at a node
+        void addToTotals(std::string_view name, int delta);
+
+        // Appends the files under n to out in name order, stopping once out holds limit
+        void collect(const FileTrieNode* n, size_t limit, std::vector<File*>& out) const;
+
+        // Removes f from the files ending under n, name[0, i) having matched the path to n, then tidies n.
+        //    Returns whether f was found.
+        bool removeFrom(FileTrieNode* parent, FileTrieNode* n, std::string_view name, size_t i, File* f);
+
+        // Takes a child out of parent's children
+        void removeChild(FileTrieNode* parent, FileTrieNode* n);
+
+        // Drops n from under parent if it has no files and no children, or merges it into its only child if it has one
+        void tidy(FileTrieNode* parent, FileTrieNode* n);
+
+        // Adds a file under the given key, which need not be its current name
+        void addUnder(std::string_view name, File* f);
+
+        // A file and where its key starts in a buffer of keys, gathered by a compaction
+        struct StoredFile {
+            size_t key;
+            size_t length;
+            File* file;
+        };
+
+        // Appends each file under n, with the key it is stored under, to stored, and the keys themselves to keys
+        void gather(const FileTrieNode* n, std::string& path, std::string& keys, std::vector<StoredFile>& stored) const;
+
+        // Rebuilds the trie into a fresh arena once more of it is outgrown arrays and dropped nodes than live data.
+        //    Files keep the keys they were stored under, even if renamed since.
+        void compactIfWasteful();
+
     public:
         // Default constructor
         FileTrie();
 
-        // Add file, ignore case
+        // Add file, ignore case. Adding a file already in the trie does nothing.
         void addFile(File* f);
 
-        // Search
-        std::unordered_set<File*> getFilesWithPrefix(const std::string& prefix) const;
+        // Removes a file filed under its current name, pruning nodes left empty. Returns whether it was found.
+        bool removeFile(File* f);
 
-        // Destructor
+        // Moves a file renamed from old_name to its current name. Returns whether it was found under old_name;
+        //    if it was not, the trie is unchanged.
+        bool renameFile(File* f, std::string_view old_name);
+
+        // Search. The returned slice is owned by the trie and stays valid until the next addFile, removeFile or renameFile.
+        //    Lays the files out again if any changed since the last search; concurrent searches wait for one layout.
+        //    As with any container, changes must not overlap searches.
+        FileSlice getFilesWithPrefix(std::string_view prefix) const;
+
+        // Returns the first limit files starting with prefix, in name order, for suggestions.
+        //    Never lays the files out: if they changed since the last search, walks just enough of the trie instead.
+        std::vector<File*> firstFilesWithPrefix(std::string_view prefix, size_t limit) const;
+
+        // Returns the number of files starting with prefix, in time proportional to the prefix alone
+        size_t countWithPrefix(std::string_view prefix) const;
+
+        // Removes every file, returning all nodes to the heap at once
+        void clear();
+
+        // Returns the number of nodes, the head included
+        size_t nodeCount() const;
+
+        // Returns the bytes the trie holds, by component
+        FileTrieMemory memoryUsage() const;
+
+        // Destructor. Frees the arena's blocks without visiting the nodes.
         ~FileTrie();
-};
\ No newline at end of file
+
+        FileTrie(const FileTrie&) = delete;
+        FileTrie& operator=(const FileTrie&) = delete;
+};
@@ -0,0 +1,116 @@
+#include "FilenameValidator.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FILENAME_SIMD 1
+#endif
+
+/**
+ * @brief Classifies name[start, length) one character at a time, continuing from what the vector loops found
+ */
+inline FilenameCheck checkScalar(const char* name, size_t start, size_t length, size_t periods, size_t period) {
+    for (size_t i = start; i < length; i++) {
+        char c = name[i];
+        bool digit = c >= '0' && c <= '9';
+        bool alpha = (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+        if (c == '.') {
+            if (++periods > 1) { return {false, period}; }
+            period = i;
+        } else if (!digit && !alpha) {
+            return {false, period};
+        }
+    }
+    return {true, period};
+}
+
+#ifdef FILENAME_SIMD
+
+/**
+ * @brief Classifies 16 bytes at a time with SSE2, which every x86-64 CPU has
+ */
+inline FilenameCheck checkSSE2(const char* name, size_t length) {
+    const __m128i before_0 = _mm_set1_epi8('0' - 1), after_9 = _mm_set1_epi8('9' + 1);
+    const __m128i before_a = _mm_set1_epi8('a' - 1), after_z = _mm_set1_epi8('z' + 1);
+    const __m128i lower_bit = _mm_set1_epi8(0x20), dot = _mm_set1_epi8('.');
+
+    size_t periods = 0;
+    size_t period = std::string::npos;
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(name + i));
+        // signed compares: bytes >= 0x80 are negative, so they fall outside every range
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, before_0), _mm_cmplt_epi8(chunk, after_9));
+        __m128i lower = _mm_or_si128(chunk, lower_bit);
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a), _mm_cmplt_epi8(lower, after_z));
+        __m128i is_dot = _mm_cmpeq_epi8(chunk, dot);
+
+        unsigned allowed = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(digit, alpha), is_dot));
+        unsigned dots = _mm_movemask_epi8(is_dot);
+        if (allowed != 0xFFFF) { return {false, period}; }
+        if (dots) {
+            periods += __builtin_popcount(dots);
+            if (periods > 1) { return {false, period}; }
+            period = i + __builtin_ctz(dots);
+        }
+    }
+    return checkScalar(name, i, length, periods, period);
+}
+
+/**
+ * @brief Classifies 32 bytes at a time with AVX2. Only called after checking the CPU supports it.
+ */
+__attribute__((target("avx2")))
+static FilenameCheck checkAVX2(const char* name, size_t length) {
+    const __m256i before_0 = _mm256_set1_epi8('0' - 1), after_9 = _mm256_set1_epi8('9' + 1);
+    const __m256i before_a = _mm256_set1_epi8('a' - 1), after_z = _mm256_set1_epi8('z' + 1);
+    const __m256i lower_bit = _mm256_set1_epi8(0x20), dot = _mm256_set1_epi8('.');
+
+    size_t periods = 0;
+    size_t period = std::string::npos;
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(name + i));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, before_0), _mm256_cmpgt_epi8(after_9, chunk));
+        __m256i lower = _mm256_or_si256(chunk, lower_bit);
+        __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, before_a), _mm256_cmpgt_epi8(after_z, lower));
+        __m256i is_dot = _mm256_cmpeq_epi8(chunk, dot);
+
+        unsigned allowed = _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(digit, alpha), is_dot));
+        unsigned dots = _mm256_movemask_epi8(is_dot);
+        if (allowed != 0xFFFFFFFFu) { return {false, period}; }
+        if (dots) {
+            periods += __builtin_popcount(dots);
+            if (periods > 1) { return {false, period}; }
+            period = i + __builtin_ctz(dots);
+        }
+    }
+    // finish a 16..31 byte tail with SSE2, carrying over what was found so far
+    if (i < length) {
+        FilenameCheck rest = checkSSE2(name + i, length - i);
+        if (!rest.valid_ || (rest.period_ != std::string::npos && periods > 0)) { return {false, period}; }
+        if (rest.period_ != std::string::npos) { period = i + rest.period_; }
+    }
+    return {true, period};
+}
+
+#endif
+
+/**
+ * @brief Classifies a filename for File's constructor.
+ * On x86 the bytes are checked 32 (AVX2, when the CPU has it) or 16 (SSE2) at a time;
+ *    the tail and all other targets use a scalar loop. Alphanumeric means ASCII [0-9A-Za-z], as std::isalnum in the "C" locale.
+ *
+ * @param name A pointer to the characters of the name
+ * @param length The number of characters
+ */
+FilenameCheck checkFilename(const char* name, size_t length) {
+#ifdef FILENAME_SIMD
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2 && length >= 32) {
+        return checkAVX2(name, length);
+    }
+    return checkSSE2(name, length);
+#else
+    return checkScalar(name, 0, length, 0, std::string::npos);
+#endif
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief The result of classifying a filename
+ */
+struct FilenameCheck {
+   bool valid_;      // True if the name only holds alphanumeric characters and at most one period
+   size_t period_;   // Position of the period, or std::string::npos if there is none
+};
+
+/**
+ * @brief Classifies a filename for File's constructor.
+ * On x86 the bytes are checked 32 (AVX2, when the CPU has it) or 16 (SSE2) at a time;
+ *    the tail and all other targets use a scalar loop. Alphanumeric means ASCII [0-9A-Za-z], as std::isalnum in the "C" locale.
+ *
+ * @param name A pointer to the characters of the name
+ * @param length The number of characters
+ */
+FilenameCheck checkFilename(const char* name, size_t length);
@@ -0,0 +1,79 @@
+#include "FrozenFileAVL.hpp"
+#include <algorithm>
+
+/**
+ * @brief Constructs an empty snapshot
+ */
+FrozenFileAVL::FrozenFileAVL() : buckets_{0}, sizes_(1, 0), ranks_(1, 0), offsets_(1, 0), files_{} {}
+
+/**
+ * @brief Constructs a snapshot from buckets given in ascending order of size
+ *
+ * @param sizes The distinct sizes, ascending
+ * @param offsets The start of each bucket within files, plus files.size() at the end
+ * @param files Every file, bucket by bucket
+ */
+FrozenFileAVL::FrozenFileAVL(const std::vector<size_t>& sizes, std::vector<size_t>&& offsets, std::vector<File*>&& files)
+    : buckets_{sizes.size()}, sizes_(sizes.size() + 1, 0), ranks_(sizes.size() + 1, 0), offsets_{std::move(offsets)}, files_{std::move(files)} {
+    size_t next = 0;
+    layout(sizes, next, 1);
+}
+
+/**
+ * @brief Assigns sorted[next...] to the Eytzinger subtree rooted at k, in order
+ */
+void FrozenFileAVL::layout(const std::vector<size_t>& sorted, size_t& next, size_t k) {
+    if (k > buckets_) {
+        return;
+    }
+    // an in-order walk of the implicit tree (children of k at 2k and 2k + 1) visits the positions in ascending order
+    layout(sorted, next, 2 * k);
+    sizes_[k] = sorted[next];
+    ranks_[k] = next;
+    next++;
+    layout(sorted, next, 2 * k + 1);
+}
+
+/**
+ * @brief Returns the rank of the first bucket whose size is not below key (buckets_ if there is none)
+ */
+size_t FrozenFileAVL::lowerBound(size_t key) const {
+    const size_t* sizes = sizes_.data();
+    size_t k = 1;
+    while (k <= buckets_) {
+        // the 8 great-grandchildren of k are adjacent and share a cache line, so one prefetch covers whichever is
+        //    reached 3 levels down
+        __builtin_prefetch(sizes + std::min(8 * k, buckets_));
+        // descend without a branch: right when the key is larger, left otherwise
+        k = 2 * k + (sizes[k] < key);
+    }
+    // undo the trailing right turns (and the final left one) to reach the last node where we went left
+    k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+    return k == 0 ? buckets_ : ranks_[k];
+}
+
+/**
+ * @brief Retrieves all files in the snapshot whose file sizes are within [min, max]
+ *
+ * @param min The min value of the file size query range.
+ * @param max The max value of the file size query range.
+ * @return The files within the given range, in ascending order of size
+ * @note As with FileAVL::query, if min >= max the interval [max, min] is searched
+ */
+FileSlice FrozenFileAVL::query(size_t min, size_t max) const {
+    if (min > max) {
+        std::swap(min, max);
+    }
+    size_t first = lowerBound(min);
+    // the buckets past max start at the first size above it
+    size_t last = (max == SIZE_MAX) ? buckets_ : lowerBound(max + 1);
+    File* const* base = files_.data();
+    return FileSlice{base + offsets_[first], base + offsets_[last]};
+}
+
+/**
+ * @brief Returns the number of files in the snapshot
+ */
+size_t FrozenFileAVL::size() const {
+    return files_.size();
+}
@@ -0,0 +1,101 @@
+/**
+ * @file FrozenFileAVL.hpp
+ * @brief Defines an immutable, array-based snapshot of a FileAVL for read-heavy range queries
+ */
+
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <new>
+
+#include "File.hpp"
+#include "FileSlice.hpp"
+
+class FileAVL;
+
+/**
+ * @brief A std::allocator that aligns each array to a cache line, so 8 adjacent size_t's starting at a multiple of 8
+ *    share one line
+ */
+template <typename T>
+struct CacheLineAllocator {
+   using value_type = T;
+   static constexpr std::size_t ALIGNMENT = 64;
+
+   CacheLineAllocator() = default;
+   template <typename U>
+   CacheLineAllocator(const CacheLineAllocator<U>&) {}
+
+   T* allocate(std::size_t n) {
+      return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ALIGNMENT}));
+   }
+   void deallocate(T* p, std::size_t) {
+      ::operator delete(p, std::align_val_t{ALIGNMENT});
+   }
+
+   template <typename U>
+   bool operator==(const CacheLineAllocator<U>&) const { return true; }
+   template <typename U>
+   bool operator!=(const CacheLineAllocator<U>&) const { return false; }
+};
+
+/**
+ * @brief A read-only snapshot of a FileAVL, produced by FileAVL::freeze()
+ * The distinct sizes are stored in Eytzinger (breadth-first) order in one contiguous array, so a search touches
+ *    one array instead of chasing Node pointers, and the next levels can be prefetched while the current one is compared.
+ * The files of all buckets are flattened into a single array in ascending order of size, so the result of a range query
+ *    is one contiguous slice of it.
+ * @note The snapshot does not follow later changes to the tree, nor to the files' contents.
+ */
+class FrozenFileAVL {
+   public:
+      /**
+       * @brief Constructs an empty snapshot
+       */
+      FrozenFileAVL();
+
+      /**
+       * @brief Retrieves all files in the snapshot whose file sizes are within [min, max]
+       *
+       * @param min The min value of the file size query range.
+       * @param max The max value of the file size query range.
+       * @return The files within the given range, in ascending order of size
+       * @note As with FileAVL::query, if min >= max the interval [max, min] is searched
+       */
+      FileSlice query(size_t min, size_t max) const;
+
+      /**
+       * @brief Returns the number of files in the snapshot
+       */
+      size_t size() const;
+
+   private:
+      friend class FileAVL;
+
+      size_t buckets_;                // The number of distinct sizes
+      // sizes_[k] for k in [1, buckets_] is the size at Eytzinger position k; sizes_[0] is unused.
+      //    Cache-line aligned, so the great-grandchildren of any k, at 8k to 8k + 7, fill exactly one line.
+      std::vector<size_t, CacheLineAllocator<size_t>> sizes_;
+      std::vector<size_t> ranks_;     // ranks_[k] is the rank (in ascending order) of the size at Eytzinger position k
+      std::vector<size_t> offsets_;   // The files of the bucket with rank r are files_[offsets_[r], offsets_[r + 1])
+      std::vector<File*> files_;
+
+      /**
+       * @brief Constructs a snapshot from buckets given in ascending order of size
+       *
+       * @param sizes The distinct sizes, ascending
+       * @param offsets The start of each bucket within files, plus files.size() at the end
+       * @param files Every file, bucket by bucket
+       */
+      FrozenFileAVL(const std::vector<size_t>& sizes, std::vector<size_t>&& offsets, std::vector<File*>&& files);
+
+      /**
+       * @brief Assigns sorted[next...] to the Eytzinger subtree rooted at k, in order
+       */
+      void layout(const std::vector<size_t>& sorted, size_t& next, size_t k);
+
+      /**
+       * @brief Returns the rank of the first bucket whose size is not below key (buckets_ if there is none)
+       */
+      size_t lowerBound(size_t key) const;
+};
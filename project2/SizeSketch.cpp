@@ -0,0 +1,170 @@
+#include "SizeSketch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief Constructs an empty sketch
+ * @param relative_error The relative error a of quantile(), in (0, 1)
+ * @throws std::invalid_argument if relative_error is outside (0, 1)
+ */
+SizeSketch::SizeSketch(double relative_error) : relative_error_{relative_error}, zeros_{0}, counts_{}, total_{0} {
+    if (!(relative_error > 0 && relative_error < 1)) {
+        throw std::invalid_argument("SizeSketch relative error must be in (0, 1)");
+    }
+    gamma_ = (1 + relative_error) / (1 - relative_error);
+    log_gamma_ = std::log(gamma_);
+}
+
+/**
+ * @brief Returns the bucket holding a size of at least 1
+ */
+size_t SizeSketch::bucket(size_t size) const {
+    return static_cast<size_t>(std::ceil(std::log(static_cast<double>(size)) / log_gamma_));
+}
+
+/**
+ * @brief Returns the size reported for bucket i: the middle of its range, in relative terms
+ */
+size_t SizeSketch::representative(size_t i) const {
+    // 2 gamma^i / (gamma + 1) is within a of both ends of (gamma^(i - 1), gamma^i]
+    double estimate = 2 * std::pow(gamma_, static_cast<double>(i)) / (gamma_ + 1);
+    return estimate >= static_cast<double>(SIZE_MAX) ? SIZE_MAX : static_cast<size_t>(std::llround(std::max(estimate, 1.0)));
+}
+
+/**
+ * @brief Returns the largest size bucket i holds
+ */
+size_t SizeSketch::upperBound(size_t i) const {
+    double bound = std::floor(std::pow(gamma_, static_cast<double>(i)));
+    return bound >= static_cast<double>(SIZE_MAX) ? SIZE_MAX : static_cast<size_t>(bound);
+}
+
+/**
+ * @brief Counts count more files of the given size
+ */
+void SizeSketch::add(size_t size, size_t count) {
+    total_ += count;
+    if (size == 0) {
+        zeros_ += count;
+        return;
+    }
+    size_t i = bucket(size);
+    if (i >= counts_.size()) {
+        counts_.resize(i + 1, 0);
+    }
+    counts_[i] += count;
+}
+
+/**
+ * @brief Uncounts count files of the given size, which must have been added
+ */
+void SizeSketch::remove(size_t size, size_t count) {
+    total_ -= count;
+    if (size == 0) {
+        zeros_ -= count;
+        return;
+    }
+    counts_[bucket(size)] -= count;
+}
+
+/**
+ * @brief Adds the counts of another sketch to this one
+ * @throws std::invalid_argument if the sketches were made with different relative errors
+ */
+void SizeSketch::merge(const SizeSketch& other) {
+    if (other.relative_error_ != relative_error_) {
+        throw std::invalid_argument("SizeSketch can only merge sketches with the same relative error");
+    }
+    if (other.counts_.size() > counts_.size()) {
+        counts_.resize(other.counts_.size(), 0);
+    }
+    for (size_t i = 0; i < other.counts_.size(); i++) {
+        counts_[i] += other.counts_[i];
+    }
+    zeros_ += other.zeros_;
+    total_ += other.total_;
+}
+
+/**
+ * @brief Forgets every size counted
+ */
+void SizeSketch::clear() {
+    counts_.clear();
+    zeros_ = 0;
+    total_ = 0;
+}
+
+/**
+ * @brief Estimates the size at quantile q (0.5 for the median, 0.99 for p99)
+ * @param q The quantile, clamped to [0, 1]
+ * @return The estimate, within the sketch's relative error of the true size at that rank, or 0 if the sketch is empty
+ */
+size_t SizeSketch::quantile(double q) const {
+    if (total_ == 0) {
+        return 0;
+    }
+    q = std::min(std::max(q, 0.0), 1.0);
+    // the 0-based rank of the file at quantile q, as std::nth_element would pick it
+    size_t rank = static_cast<size_t>(q * static_cast<double>(total_ - 1));
+    size_t seen = zeros_;
+    if (rank < seen) {
+        return 0;
+    }
+    for (size_t i = 0; i < counts_.size(); i++) {
+        seen += counts_[i];
+        if (rank < seen) {
+            return representative(i);
+        }
+    }
+    return representative(counts_.size() - 1);
+}
+
+/**
+ * @brief Estimates the fraction of files whose size is no larger than size
+ * @return The fraction in [0, 1], or 0 if the sketch is empty
+ */
+double SizeSketch::cdf(size_t size) const {
+    if (total_ == 0) {
+        return 0;
+    }
+    size_t below = zeros_;
+    if (size > 0) {
+        size_t end = std::min(bucket(size) + 1, counts_.size());
+        for (size_t i = 0; i < end; i++) {
+            below += counts_[i];
+        }
+    }
+    return static_cast<double>(below) / static_cast<double>(total_);
+}
+
+/**
+ * @brief Returns the non-empty buckets in increasing order, as (largest size the bucket holds, number of files) pairs
+ */
+std::vector<std::pair<size_t, size_t>> SizeSketch::histogram() const {
+    std::vector<std::pair<size_t, size_t>> buckets;
+    if (zeros_ > 0) {
+        buckets.emplace_back(0, zeros_);
+    }
+    for (size_t i = 0; i < counts_.size(); i++) {
+        if (counts_[i] > 0) {
+            buckets.emplace_back(upperBound(i), counts_[i]);
+        }
+    }
+    return buckets;
+}
+
+/**
+ * @brief Returns the number of files counted
+ */
+size_t SizeSketch::count() const {
+    return total_;
+}
+
+/**
+ * @brief Returns the relative error the sketch was made with
+ */
+double SizeSketch::relativeError() const {
+    return relative_error_;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file SizeSketch.hpp
+ * @brief Defines a bounded-memory, mergeable sketch of a distribution of file sizes, for approximate quantiles
+ */
+
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @brief A log-bucketed histogram of file sizes (in the style of DDSketch) answering quantile and CDF queries
+ * Size x >= 1 is counted in bucket ceil(log_gamma(x)), where gamma = (1 + a) / (1 - a) for relative error a, and 0 in
+ *    a bucket of its own. Every size in a bucket is within a factor of (1 + a) / (1 - a) of the others, so:
+ *    - quantile(q) is within relative error a of the true size at rank q (exact for 0)
+ *    - cdf(x) counts every size in x's bucket as no larger than x, so it may include sizes up to a factor gamma above x
+ * Memory is one counter per bucket reached, at most ceil(log_gamma(SIZE_MAX)) + 2: about 2200 for a = 1%.
+ * Since it only keeps counts, sizes can be removed exactly, and two sketches with the same error merge by adding counts.
+ */
+class SizeSketch {
+   public:
+      /**
+       * @brief Constructs an empty sketch
+       * @param relative_error The relative error a of quantile(), in (0, 1)
+       * @throws std::invalid_argument if relative_error is outside (0, 1)
+       */
+      explicit SizeSketch(double relative_error = 0.01);
+
+      /**
+       * @brief Counts count more files of the given size
+       */
+      void add(size_t size, size_t count = 1);
+
+      /**
+       * @brief Uncounts count files of the given size, which must have been added
+       */
+      void remove(size_t size, size_t count = 1);
+
+      /**
+       * @brief Adds the counts of another sketch to this one
+       * @throws std::invalid_argument if the sketches were made with different relative errors
+       */
+      void merge(const SizeSketch& other);
+
+      /**
+       * @brief Forgets every size counted
+       */
+      void clear();
+
+      /**
+       * @brief Estimates the size at quantile q (0.5 for the median, 0.99 for p99)
+       * @param q The quantile, clamped to [0, 1]
+       * @return The estimate, within the sketch's relative error of the true size at that rank, or 0 if the sketch is empty
+       */
+      size_t quantile(double q) const;
+
+      /**
+       * @brief Estimates the fraction of files whose size is no larger than size
+       * @return The fraction in [0, 1], or 0 if the sketch is empty
+       */
+      double cdf(size_t size) const;
+
+      /**
+       * @brief Returns the non-empty buckets in increasing order, as (largest size the bucket holds, number of files) pairs
+       */
+      std::vector<std::pair<size_t, size_t>> histogram() const;
+
+      /**
+       * @brief Returns the number of files counted
+       */
+      size_t count() const;
+
+      /**
+       * @brief Returns the relative error the sketch was made with
+       */
+      double relativeError() const;
+
+   private:
+      double relative_error_;
+      double gamma_;
+      double log_gamma_;
+      size_t zeros_;                  // The number of files of size 0
+      std::vector<size_t> counts_;    // counts_[i] is the number of files of size in (gamma^(i - 1), gamma^i]
+      size_t total_;
+
+      /**
+       * @brief Returns the bucket holding a size of at least 1
+       */
+      size_t bucket(size_t size) const;
+
+      /**
+       * @brief Returns the size reported for bucket i: the middle of its range, in relative terms
+       */
+      size_t representative(size_t i) const;
+
+      /**
+       * @brief Returns the largest size bucket i holds
+       */
+      size_t upperBound(size_t i) const;
+};
@@ -0,0 +1,285 @@
+#include "File.hpp"
+#include "FileAVL.hpp"
+#include "ConcurrentFileAVL.hpp"
+#include "FileBPlusTree.hpp"
+#include "FileTrie.hpp"
+#include "FilenameValidator.hpp"
+#include <cctype>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+/**
+ * @brief Times fn, returning the elapsed milliseconds
+ */
+template <typename Function>
+double timeMs(Function fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief The character-at-a-time check File's constructor used before checkFilename, kept as a baseline
+ */
+bool legacyCheck(const std::string& filename) {
+    bool seen_period = false;
+    for (char c : filename) {
+        if (c == '.' && !seen_period) {
+            seen_period = true;
+        } else if (!std::isalnum(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void benchFilenames() {
+    const size_t COUNT = 1000000;
+    std::vector<std::string> names;
+    names.reserve(COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        // a mix of short names and longer, generated ones
+        names.push_back((i % 4 == 0 ? "QuarterlyReportDraftRevision" : "doc") + std::to_string(i) + (i % 3 ? ".txt" : ""));
+    }
+
+    size_t valid = 0;
+    double legacy = timeMs([&] { for (const std::string& name : names) { valid += legacyCheck(name); } });
+    double vectorized = timeMs([&] { for (const std::string& name : names) { valid += checkFilename(name.data(), name.size()).valid_; } });
+    std::cout << "validate " << COUNT << " names: scalar " << legacy << " ms, vectorized " << vectorized << " ms (" << valid << ")" << std::endl;
+
+    std::vector<File> one_by_one;
+    double single = timeMs([&] {
+        one_by_one.reserve(COUNT);
+        for (const std::string& name : names) { one_by_one.emplace_back(name); }
+    });
+    std::vector<File> batch;
+    double bulk = timeMs([&] { batch = File::fromNames(names); });
+    std::cout << "construct " << COUNT << " files: constructor " << single << " ms, File::fromNames " << bulk << " ms" << std::endl;
+}
+
+/**
+ * @brief Makes count files with sizes drawn uniformly from [0, max_size)
+ */
+std::vector<File> makeSizedFiles(size_t count, size_t max_size) {
+    std::mt19937 random(335);
+    std::string filler(max_size, 'x');
+    std::vector<File> files;
+    files.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        files.emplace_back("file" + std::to_string(i), filler.substr(0, random() % max_size));
+    }
+    return files;
+}
+
+void benchBuild() {
+    const size_t COUNT = 200000;
+    // about 200 MB of contents, with up to 2000 distinct sizes
+    std::vector<File> files = makeSizedFiles(COUNT, 2000);
+    std::vector<File*> pointers;
+    for (File& file : files) { pointers.push_back(&file); }
+
+    FileAVL inserted;
+    double repeated = timeMs([&] { for (File* file : pointers) { inserted.insert(file); } });
+    FileAVL built;
+    double bulk = timeMs([&] { built.build(pointers); });
+    std::sort(pointers.begin(), pointers.end(), [](File* lhs, File* rhs) { return lhs->getSize() < rhs->getSize(); });
+    FileAVL presorted;
+    double linear = timeMs([&] { presorted.build(pointers, true); });
+    std::cout << "index " << COUNT << " files: insert " << repeated << " ms, build " << bulk << " ms, build (presorted) " << linear << " ms" << std::endl;
+}
+
+void benchFrozen() {
+    const size_t COUNT = 200000;
+    const size_t QUERIES = 1000000;
+    std::vector<File> files = makeSizedFiles(COUNT, 2000);
+    FileAVL tree;
+    for (File& file : files) { tree.insert(&file); }
+    FrozenFileAVL frozen;
+    double freezing = timeMs([&] { frozen = tree.freeze(); });
+
+    // narrow ranges, so the cost is dominated by the search rather than by copying out the result
+    std::mt19937 random(335);
+    std::vector<size_t> lows(QUERIES);
+    for (size_t& low : lows) { low = random() % 2000; }
+    size_t found = 0;
+    double pointers = timeMs([&] { for (size_t low : lows) { found += tree.query(low, low + 2).size(); } });
+    double eytzinger = timeMs([&] { for (size_t low : lows) { found += frozen.query(low, low + 2).size(); } });
+    std::cout << "query " << QUERIES << " ranges: tree " << pointers << " ms, frozen " << eytzinger << " ms (freeze " << freezing << " ms, " << found << ")" << std::endl;
+}
+
+void benchQueryMany() {
+    const size_t COUNT = 200000;
+    const size_t BANDS = 50;
+    const size_t ROUNDS = 100;
+    std::vector<File> files = makeSizedFiles(COUNT, 2000);
+    FileAVL tree;
+    for (File& file : files) { tree.insert(&file); }
+
+    // narrow histogram bands spread over the sizes, with gaps between them
+    std::vector<std::pair<size_t, size_t>> bands;
+    for (size_t b = 0; b < BANDS; b++) {
+        bands.emplace_back(b * 40, b * 40 + 4);
+    }
+    size_t found = 0;
+    double single = timeMs([&] {
+        for (size_t i = 0; i < ROUNDS; i++) {
+            for (const std::pair<size_t, size_t>& band : bands) { found += tree.query(band.first, band.second).size(); }
+        }
+    });
+    double batched = timeMs([&] {
+        for (size_t i = 0; i < ROUNDS; i++) {
+            for (const std::vector<File*>& result : tree.queryMany(bands)) { found += result.size(); }
+        }
+    });
+    std::cout << "query " << ROUNDS << " x " << BANDS << " bands: one by one " << single << " ms, queryMany " << batched << " ms (" << found << ")" << std::endl;
+}
+
+/**
+ * @brief Runs readers queries on each of readers threads while ingest runs, returning the queries completed per reader
+ */
+template <typename Query, typename Ingest>
+double readsDuring(size_t readers, Query query, Ingest ingest) {
+    std::atomic<bool> running{true};
+    std::atomic<size_t> completed{0};
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; r++) {
+        threads.emplace_back([&, r] {
+            size_t done = 0;
+            for (size_t low = r; running; low = (low + 7) % 2000, done++) {
+                query(low, low + 10);
+            }
+            completed += done;
+        });
+    }
+    ingest();
+    running = false;
+    for (std::thread& thread : threads) { thread.join(); }
+    return static_cast<double>(completed) / readers;
+}
+
+void benchConcurrent() {
+    const size_t COUNT = 100000;
+    const size_t READERS = 4;
+    std::vector<File> files = makeSizedFiles(COUNT, 2000);
+
+    // the plain tree needs every query to wait out each insert
+    FileAVL locked;
+    std::mutex lock;
+    double lockedMs = 0;
+    double lockedReads = readsDuring(READERS,
+        [&](size_t min, size_t max) { std::lock_guard<std::mutex> guard(lock); return locked.query(min, max).size(); },
+        [&] { lockedMs = timeMs([&] { for (File& file : files) { std::lock_guard<std::mutex> guard(lock); locked.insert(&file); } }); });
+
+    ConcurrentFileAVL shared;
+    double sharedMs = 0;
+    double sharedReads = readsDuring(READERS,
+        [&](size_t min, size_t max) { return shared.query(min, max).size(); },
+        [&] { sharedMs = timeMs([&] { for (File& file : files) { shared.insert(&file); } }); });
+    std::cout << "ingest " << COUNT << " files with " << READERS << " readers: mutex " << lockedMs << " ms (" << lockedReads / lockedMs
+              << " queries/ms/reader), concurrent " << sharedMs << " ms (" << sharedReads / sharedMs << " queries/ms/reader)" << std::endl;
+}
+
+/**
+ * @brief Times inserting every file into index, then QUERIES narrow range queries, printing both under label
+ */
+template <typename Index>
+void benchIndex(const char* label, Index& index, std::vector<File>& files) {
+    const size_t QUERIES = 100000;
+    double inserting = timeMs([&] { for (File& file : files) { index.insert(&file); } });
+    size_t found = 0;
+    double querying = timeMs([&] {
+        for (size_t i = 0; i < QUERIES; i++) {
+            size_t low = (i * 7919) % 2048;
+            found += index.query(low, low + 2).size();
+        }
+    });
+    std::cout << "  " << label << ": insert " << files.size() / inserting << " files/ms, query " << QUERIES / querying << " queries/ms (" << found << ")" << std::endl;
+}
+
+void benchBPlusTree() {
+    // each File owns its contents, so 10^7 files of up to 2 KB would not fit in memory: stop at 10^6
+    for (size_t count = 1000; count <= 1000000; count *= 10) {
+        std::vector<File> files = makeSizedFiles(count, 2048);
+        std::cout << "index " << count << " files:" << std::endl;
+        FileAVL avl;
+        benchIndex("FileAVL", avl, files);
+        FileBPlusTree bplus;
+        benchIndex("FileBPlusTree", bplus, files);
+    }
+}
+
+void benchSketch() {
+    const size_t COUNT = 200000;
+    std::vector<File> files = makeSizedFiles(COUNT, 2000);
+    FileAVL tree;
+    for (File& file : files) { tree.insert(&file); }
+
+    size_t p99 = 0;
+    double sorting = timeMs([&] {
+        std::vector<File*> all = tree.query(0, SIZE_MAX);
+        std::sort(all.begin(), all.end(), [](File* lhs, File* rhs) { return lhs->getSize() < rhs->getSize(); });
+        p99 = all[(all.size() - 1) * 99 / 100]->getSize();
+    });
+    size_t estimate = 0;
+    double sketching = timeMs([&] { estimate = tree.sizeSketch().quantile(0.99); });
+    std::cout << "p99 of " << COUNT << " files: query and sort " << sorting << " ms (" << p99 << "), sketch " << sketching * 1000 << " us (" << estimate << ")" << std::endl;
+}
+
+void benchTrie() {
+    const size_t COUNT = 200000;
+    const size_t LOOKUPS = 1000000;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < COUNT; i++) {
+        names.push_back((i % 4 == 0 ? "QuarterlyReport" : "doc") + std::to_string(i * 7919 % COUNT) + (i % 3 ? ".txt" : ".md"));
+    }
+    std::vector<File> files = File::fromNames(names);
+
+    FileTrie trie;
+    double adding = timeMs([&] { for (File& file : files) { trie.addFile(&file); } });
+    size_t found = 0;
+    double searching = timeMs([&] {
+        for (size_t i = 0; i < LOOKUPS; i++) {
+            found += trie.getFilesWithPrefix(std::string_view(names[i % COUNT]).substr(0, 2 + i % 8)).size();
+        }
+    });
+    FileTrieMemory usage = trie.memoryUsage();
+    std::cout << "trie " << COUNT << " names: add " << adding << " ms, prefix lookup " << searching * 1e6 / LOOKUPS << " ns, "
+              << trie.nodeCount() << " nodes of " << static_cast<double>(usage.total()) / trie.nodeCount() << " bytes (" << found << ")" << std::endl;
+    std::cout << "  bytes: nodes " << usage.nodes << ", labels " << usage.labels << ", children " << usage.children << ", files " << usage.files
+              << ", wasted " << usage.wasted << ", reserved " << usage.reserved << ", layout " << usage.layout << std::endl;
+    // take out and put back a quarter of the files at a time, searching after each round so layout is included
+    double churning = timeMs([&] {
+        for (size_t round = 0; round < 4; round++) {
+            for (size_t i = round; i < COUNT; i += 4) { trie.removeFile(&files[i]); }
+            for (size_t i = round; i < COUNT; i += 4) { trie.addFile(&files[i]); }
+            found += trie.getFilesWithPrefix("doc").size();
+        }
+    });
+    std::cout << "  remove and re-add every file " << churning * 1e6 / (2 * COUNT) << " ns per change, "
+              << trie.nodeCount() << " nodes, reserved " << trie.memoryUsage().reserved << std::endl;
+    // suggestions and counts interleaved with changes, so the layout is always stale
+    double suggesting = timeMs([&] {
+        for (size_t i = 0; i < LOOKUPS / 10; i++) {
+            trie.removeFile(&files[i % COUNT]);
+            trie.addFile(&files[i % COUNT]);
+            std::string_view prefix = std::string_view(names[i % COUNT]).substr(0, 1 + i % 4);
+            found += trie.firstFilesWithPrefix(prefix, 10).size() + trie.countWithPrefix(prefix);
+        }
+    });
+    std::cout << "  change, 10 suggestions and count " << suggesting * 1e6 / (LOOKUPS / 10) << " ns (" << found << ")" << std::endl;
+    double clearing = timeMs([&] { trie.clear(); });
+    std::cout << "  clear " << clearing << " ms" << std::endl;
+}
+
+int main() {
+    benchFilenames();
+    benchBuild();
+    benchFrozen();
+    benchQueryMany();
+    benchConcurrent();
+    benchBPlusTree();
+    benchSketch();
+    benchTrie();
+}
@@ -1,5 +1,45 @@
 #include "FileAVL.hpp"
 #include "FileTrie.hpp"
+#include "ConcurrentFileAVL.hpp"
+#include "FileBPlusTree.hpp"
+#include "FileIndex.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <thread>
+
+// Counts every heap allocation made by the program (from any thread), so tests can check that a code path makes none
+static std::atomic<size_t> allocations{0};
+
+// kept out of line so the compiler pairs the malloc/free below with each other, not with new/delete
+__attribute__((noinline)) void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+
+// the nothrow forms (used by std::stable_sort's temporary buffer) must come from malloc too, since delete frees
+__attribute__((noinline)) void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+__attribute__((noinline)) void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept { std::free(p); }
 
 bool testQuery(FileAVL* tree, const int &min, const int &max, const std::vector<File*> &expected) {
     std::vector<File*> result = tree->query(min, max); 
@@ -100,7 +140,7 @@ int main() {
     }
 
     std::cout << "testing trie" << std::endl;
-    std::unordered_set<File*> set;
+    FileSlice set;
 
     // full trie print
     set = trie->getFilesWithPrefix("");
@@ -164,4 +204,632 @@ int main() {
         std::cout << (*it)->getName() << "  ";
     }
     std::cout << std::endl;
-}
\ No newline at end of file
+
+    std::cout << "file name tests" << std::endl;
+    // test bulk construction applies the constructor's defaults
+    std::vector<File> batch = File::fromNames({"report", "notes.", "Photo.PNG", "", "a1234567890123456789012345678901234567890.md"});
+    if (batch[0].getName() == "report.txt" && batch[1].getName() == "notes.txt" && batch[2].getName() == "Photo.PNG"
+        && batch[3].getName() == "NewFile.txt" && batch[4].getName() == "a1234567890123456789012345678901234567890.md") {
+        std::cout << "passed test 7" << std::endl;
+    }
+    else {
+        std::cout << "failed test 7" << std::endl;
+    }
+
+    // test invalid names are rejected, including past the first 16/32 characters
+    int rejected = 0;
+    for (const char* name : {"a.b.c", "has space.txt", "abcdefghijklmnopqrstuvwxyzabcdefghij-.txt", "abcdefghijklmnopqrstuvwxyz.abcdefghij.txt"}) {
+        try { File f(name); } catch (const InvalidFormatException&) { rejected++; }
+    }
+    if (rejected == 4) {
+        std::cout << "passed test 8" << std::endl;
+    }
+    else {
+        std::cout << "failed test 8" << std::endl;
+    }
+
+    // test that sorting by name, prefix lookups, re-adding known files to the trie
+    //    and querying an empty range of the tree make no heap allocations.
+    //    The long name is past the small-string buffer, so any copy of it would allocate.
+    File* f8 = new File("averyverylongfilenamethatisnotstoredinline.txt", "");
+    trie->addFile(f8);
+    std::vector<File*> byName = allFiles;
+    byName.push_back(f8);
+    size_t before = allocations;
+    std::sort(byName.begin(), byName.end(), [](File* lhs, File* rhs) { return *lhs < *rhs; });
+    size_t matches = trie->getFilesWithPrefix("ab").size() + trie->getFilesWithPrefix("zzz").size();
+    for (File* file : byName) {
+        trie->addFile(file);
+    }
+    std::vector<File*> none = tree->query(10, 100);
+    size_t made = allocations - before;
+    if (made == 0 && matches == 3 && none.empty() && byName.front() == f6 && byName.back() == f5) {
+        std::cout << "passed test 9" << std::endl;
+    }
+    else {
+        std::cout << "failed test 9 (" << made << " allocations)" << std::endl;
+    }
+
+    // test inline and spilled names: extension split, hash, comparison and the moved-from state
+    FileName shortName("Photo.PNG");
+    FileName longName(std::string(40, 'a'), ".md");
+    FileName moved(std::move(longName));
+    // moved out of a File in no index, so the trees and trie below never see a gutted one
+    File* unindexed = new File("a.txt", "abc");
+    File movedFile(std::move(*unindexed));
+    bool namesOk = shortName.base() == "Photo" && shortName.extension() == "PNG" && shortName == FileName("Photo.PNG")
+        && moved.size() == 43 && moved.extension() == "md" && moved.hash() == FileName::hashOf(moved.view())
+        && (shortName < moved) == (shortName.view() < moved.view()) && FileName("noext").period() == FileName::NO_EXTENSION
+        && FileName(std::string(19, 'q'), ".txt").extension() == "txt" && FileName(std::string(23, 'q')).period() == FileName::NO_EXTENSION
+        && longName.empty() && longName.hash() == FileName().hash() && unindexed->getName().empty() && movedFile.getName() == "a.txt" && f1->getName() == "a.txt";
+    if (namesOk) {
+        std::cout << "passed test 10" << std::endl;
+    }
+    else {
+        std::cout << "failed test 10" << std::endl;
+    }
+
+    // test removal (including a Node with two children and a shared bucket) and re-keying after an edit
+    FileAVL* churn = new FileAVL();
+    File* g1 = new File("g1.txt", "12");
+    File* g2 = new File("g2.txt", "1234");
+    File* g3 = new File("g3.txt", "1234");
+    File* g4 = new File("g4.txt", "123456");
+    File* g5 = new File("g5.txt", "1");
+    for (File* file : {g1, g2, g3, g4, g5}) {
+        churn->insert(file);
+    }
+    bool churnOk = churn->remove(g2) && !churn->remove(g2) && churn->remove(g1) && churn->size() == 3;
+    churnOk = churnOk && testQuery(churn, 0, 100, {g5, g3, g4});
+    *g5 = File("g5.txt", "12345678");
+    churnOk = churnOk && churn->updateSize(g5, 1) && !churn->updateSize(g5, 1) && testQuery(churn, 0, 100, {g3, g4, g5});
+    churnOk = churnOk && churn->remove(g3) && churn->remove(g4) && churn->remove(g5) && churn->size() == 0 && churn->height(nullptr) == -1;
+    if (churnOk) {
+        std::cout << "passed test 11" << std::endl;
+    }
+    else {
+        std::cout << "failed test 11" << std::endl;
+    }
+
+    // test bulk loading matches inserting one by one, including the order within a bucket
+    FileAVL* built = new FileAVL();
+    built->build({f7, f3, g3, f2, f4, g4});
+    bool buildOk = built->size() == 6 && testQuery(built, 0, 100, {f2, f3, g3, f4, g4, f7}) && built->height(nullptr) == -1;
+    built->build({f2, f3, f4}, true);
+    buildOk = buildOk && built->size() == 3 && testQuery(built, 3, 2, {f2, f3}) && built->remove(f3) && testQuery(built, 0, 100, {f2, f4});
+    if (buildOk) {
+        std::cout << "passed test 12" << std::endl;
+    }
+    else {
+        std::cout << "failed test 12" << std::endl;
+    }
+
+    // test the frozen snapshot answers like the tree, as one contiguous slice, and ignores later changes
+    FrozenFileAVL frozen = tree->freeze();
+    FileSlice middle = frozen.query(4, 2);
+    FileSlice everything = frozen.query(0, 100);
+    std::vector<File*> fromSlice(middle.begin(), middle.end());
+    tree->insert(g1);
+    bool frozenOk = fromSlice == std::vector<File*>{f2, f3, f4} && frozen.query(10, 100).empty() && everything.size() == allFiles.size()
+        && frozen.size() == allFiles.size() && everything.end() == middle.end() + 3 && frozen.query(2, 2).size() == 1
+        && tree->query(2, 2).size() == 2 && FrozenFileAVL().query(0, 100).empty();
+    if (frozenOk) {
+        std::cout << "passed test 13" << std::endl;
+    }
+    else {
+        std::cout << "failed test 13" << std::endl;
+    }
+
+    // test order statistics against query, including after rotations, removals and a bulk load
+    bool statsOk = tree->countInRange(2, 4) == 4 && tree->bytesInRange(4, 2) == 11 && tree->kthSmallest(2) == g1
+        && tree->rankOf(3) == 3 && tree->kthSmallest(tree->rankOf(3)) == f3 && tree->kthSmallest(8) == nullptr;
+    std::vector<File*> mixed;
+    for (size_t i = 0; i < 60; i++) {
+        mixed.push_back(new File("m" + std::to_string(i) + ".txt", std::string((i * 7) % 23, 'x')));
+    }
+    FileAVL* stats = new FileAVL();
+    for (File* file : mixed) {
+        stats->insert(file);
+    }
+    for (size_t i = 0; i < mixed.size(); i += 3) {
+        stats->remove(mixed[i]);
+    }
+    built->build(mixed);
+    for (FileAVL* index : {stats, built}) {
+        for (size_t min = 0; min < 25; min++) {
+            for (size_t max = 0; max < 25; max += 4) {
+                std::vector<File*> found = index->query(min, max);
+                size_t bytes = 0;
+                for (File* file : found) {
+                    bytes += file->getSize();
+                }
+                statsOk = statsOk && index->countInRange(min, max) == found.size() && index->bytesInRange(min, max) == bytes;
+            }
+        }
+        std::vector<File*> all = index->query(0, SIZE_MAX);
+        for (size_t k = 0; k < all.size(); k++) {
+            statsOk = statsOk && index->kthSmallest(k) == all[k] && index->rankOf(all[k]->getSize()) <= k;
+        }
+    }
+    if (statsOk) {
+        std::cout << "passed test 14" << std::endl;
+    }
+    else {
+        std::cout << "failed test 14" << std::endl;
+    }
+
+    // test cursors: paging through tokens, largest-first, early stops, no allocations per file, resuming after an insert
+    std::vector<File*> expectedPages = stats->query(20, 3);
+    std::vector<File*> paged;
+    PageToken token = stats->cursor(3, 20).token();
+    while (!token.done_) {
+        FileCursor page = stats->resume(token);
+        page.take(paged, 7);
+        token = page.token();
+    }
+    std::vector<File*> backward;
+    FileCursor largest = stats->cursor(3, 20, true);
+    before = allocations;
+    size_t walked = 0;
+    while (largest.next() != nullptr) {
+        walked++;
+    }
+    made = allocations - before;
+    largest = stats->cursor(3, 20, true);
+    largest.take(backward, SIZE_MAX);
+    bool cursorOk = paged == expectedPages && made == 0 && walked == expectedPages.size()
+        && std::equal(backward.begin(), backward.end(), expectedPages.rbegin(), expectedPages.rend());
+    size_t seen = 0;
+    cursorOk = cursorOk && stats->visit(0, 100, [&](File*) { return ++seen < 5; }) == 5 && stats->visit(30, 100, [](File*) { return true; }) == 0;
+    FileCursor resumed = stats->cursor(0, 100);
+    std::vector<File*> firstPage;
+    resumed.take(firstPage, 5);
+    token = resumed.token();
+    bool pageOk = firstPage.back() == stats->kthSmallest(4) && firstPage.back()->getSize() > 0;
+    File* behind = new File("behind.txt", "");
+    File* ahead = new File("ahead.txt", std::string(22, 'x'));
+    stats->insert(behind);
+    stats->insert(ahead);
+    std::vector<File*> rest;
+    stats->resume(token).take(rest, SIZE_MAX);
+    cursorOk = cursorOk && pageOk && rest.size() + 5 == static_cast<size_t>(stats->size()) - 1 && rest.back() == ahead
+        && std::find(rest.begin(), rest.end(), behind) == rest.end() && nullTree->cursor(0, 100).next() == nullptr;
+    if (cursorOk) {
+        std::cout << "passed test 15" << std::endl;
+    }
+    else {
+        std::cout << "failed test 15" << std::endl;
+    }
+
+    // test multi-range queries match single queries, with overlapping, swapped, empty and unsorted ranges
+    std::vector<std::pair<size_t, size_t>> bands = {{10, 14}, {0, 3}, {12, 20}, {6, 2}, {30, 40}, {5, 5}, {0, SIZE_MAX}};
+    std::vector<std::vector<File*>> banded = stats->queryMany(bands);
+    bool manyOk = banded.size() == bands.size() && nullTree->queryMany(bands)[6].empty() && stats->queryMany({}).empty();
+    for (size_t r = 0; r < bands.size(); r++) {
+        manyOk = manyOk && banded[r] == stats->query(bands[r].first, bands[r].second);
+    }
+    if (manyOk) {
+        std::cout << "passed test 16" << std::endl;
+    }
+    else {
+        std::cout << "failed test 16" << std::endl;
+    }
+
+    // test concurrent queries see consistent, growing snapshots while files are inserted, and end up like a FileAVL
+    ConcurrentFileAVL* shared = new ConcurrentFileAVL();
+    std::vector<File*> ingest;
+    for (size_t i = 0; i < 2000; i++) {
+        ingest.push_back(new File("c" + std::to_string(i) + ".txt", std::string((i * 37) % 101, 'x')));
+    }
+    std::atomic<bool> ingesting{true};
+    std::atomic<bool> readsOk{true};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&] {
+            size_t last = 0;
+            while (ingesting) {
+                ConcurrentFileAVL::Snapshot view = shared->snapshot();
+                std::vector<File*> seen = view.query(100, 0);
+                bool sorted = std::is_sorted(seen.begin(), seen.end(), [](File* lhs, File* rhs) { return lhs->getSize() < rhs->getSize(); });
+                if (!sorted || seen.size() != view.size() || view.size() < last) {
+                    readsOk = false;
+                }
+                last = view.size();
+            }
+        });
+    }
+    for (File* file : ingest) {
+        shared->insert(file);
+    }
+    ingesting = false;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    FileAVL* serial = new FileAVL();
+    for (File* file : ingest) {
+        serial->insert(file);
+    }
+    shared->insert(f2);
+    serial->insert(f2);
+    bool concurrentOk = readsOk && shared->size() == ingest.size() + 1 && shared->retiredCount() == 0
+        && shared->query(0, 100) == serial->query(0, 100) && shared->query(60, 40) == serial->query(40, 60);
+    if (concurrentOk) {
+        std::cout << "passed test 17" << std::endl;
+    }
+    else {
+        std::cout << "failed test 17" << std::endl;
+    }
+
+    // test the B+-tree answers like a FileAVL once it is several levels deep, including empty and swapped ranges
+    FileBPlusTree* wide = new FileBPlusTree();
+    FileAVL* narrow = new FileAVL();
+    bool wideOk = wide->query(0, 100).empty();
+    std::vector<File*> spread;
+    for (size_t i = 0; i < 3000; i++) {
+        spread.push_back(new File("w" + std::to_string(i) + ".txt", std::string((i * 7919) % 2500, 'x')));
+        wide->insert(spread.back());
+        narrow->insert(spread.back());
+    }
+    for (size_t min = 0; min < 2600; min += 97) {
+        wideOk = wideOk && wide->query(min, min + 150) == narrow->query(min, min + 150) && wide->query(min, 3) == narrow->query(3, min);
+    }
+    wideOk = wideOk && wide->size() == 3000 && wide->query(0, SIZE_MAX) == narrow->query(0, SIZE_MAX) && wide->query(5000, 6000).empty();
+    if (wideOk) {
+        std::cout << "passed test 18" << std::endl;
+    }
+    else {
+        std::cout << "failed test 18" << std::endl;
+    }
+
+    // test indices on other keys: sizes like a FileAVL, extensions as strings, name lengths, and identical icons sharing a key
+    FileSizeIndex* bySize = new FileSizeIndex();
+    FileExtensionIndex* byExtension = new FileExtensionIndex();
+    FileNameLengthIndex* byLength = new FileNameLengthIndex();
+    for (File* file : spread) {
+        bySize->insert(file);
+    }
+    bool indexOk = bySize->query(2000, 100) == narrow->query(100, 2000) && bySize->size() == narrow->size() && bySize->remove(spread[7])
+        && !bySize->remove(spread[7]) && bySize->height(nullptr) == -1;
+    File* doc = new File("report.doc", "");
+    File* md = new File("notes.md", "");
+    File* md2 = new File("readme.md", "");
+    for (File* file : {doc, md, md2, f7}) {
+        byExtension->insert(file);
+        byLength->insert(file);
+    }
+    indexOk = indexOk && byExtension->find("md") == std::vector<File*>{md, md2} && byExtension->query("e", "doc") == std::vector<File*>{doc}
+        && byExtension->query("a", "z").size() == 4 && byLength->query(8, 9) == std::vector<File*>{md, md2} && byLength->find(5) == std::vector<File*>{f7};
+    int* pixels = new int[IconKey::ICON_DIM];
+    int* samePixels = new int[IconKey::ICON_DIM];
+    for (size_t pixel = 0; pixel < IconKey::ICON_DIM; pixel++) {
+        pixels[pixel] = samePixels[pixel] = static_cast<int>(pixel % 7);
+    }
+    File* iconA = new File("iconA.txt", "", pixels);
+    File* iconB = new File("iconB.txt", "", samePixels);
+    FileIconIndex* byIcon = new FileIconIndex();
+    for (File* file : {iconA, doc, iconB}) {
+        byIcon->insert(file);
+    }
+    indexOk = indexOk && byIcon->find(IconKey()(iconA)) == std::vector<File*>{iconA, iconB} && byIcon->find(0) == std::vector<File*>{doc};
+    if (indexOk) {
+        std::cout << "passed test 19" << std::endl;
+    }
+    else {
+        std::cout << "failed test 19" << std::endl;
+    }
+
+    // test size quantiles stay within the sketch's error of the exact order statistics, through removals, bulk loads and merges
+    auto withinError = [](const FileAVL* index, double q) {
+        size_t exact = index->kthSmallest(static_cast<size_t>(q * (index->size() - 1)))->getSize();
+        size_t estimate = index->sizeSketch().quantile(q);
+        return std::abs(static_cast<double>(estimate) - static_cast<double>(exact)) <= 0.01 * exact + 0.5;
+    };
+    bool sketchOk = nullTree->sizeSketch().quantile(0.5) == 0 && narrow->sizeSketch().count() == 3000;
+    for (double q : {0.0, 0.01, 0.5, 0.95, 0.99, 1.0}) {
+        sketchOk = sketchOk && withinError(narrow, q) && withinError(built, q);
+    }
+    for (size_t i = 0; i < spread.size(); i += 2) {
+        narrow->remove(spread[i]);
+    }
+    SizeSketch halves;
+    halves.merge(narrow->sizeSketch());
+    halves.merge(built->sizeSketch());
+    sketchOk = sketchOk && withinError(narrow, 0.5) && withinError(narrow, 0.99) && narrow->sizeSketch().count() == 1500
+        && halves.count() == 1500 + mixed.size() && halves.histogram().size() >= narrow->sizeSketch().histogram().size()
+        && std::abs(narrow->sizeSketch().cdf(1250) - narrow->countInRange(0, 1250) / 1500.0) < 0.01;
+    try {
+        halves.merge(SizeSketch(0.05));
+        sketchOk = false;
+    } catch (const std::invalid_argument&) {}
+    if (sketchOk) {
+        std::cout << "passed test 20" << std::endl;
+    }
+    else {
+        std::cout << "failed test 20" << std::endl;
+    }
+
+    // test the compressed trie against a scan of the names: sorted slices, prefixes ending part way along an edge, and nesting
+    FileTrie* names = new FileTrie();
+    for (File* file : spread) {
+        names->addFile(file);
+    }
+    names->addFile(doc);
+    names->addFile(doc);
+    auto lowered = [](std::string_view name) {
+        std::string lower(name);
+        for (char& c : lower) { c = char(tolower(c)); }
+        return lower;
+    };
+    bool trieOk = names->getFilesWithPrefix("").size() == spread.size() + 1;
+    for (std::string prefix : {"w1", "W12", "w123", "w1234", "w2999.", "w2999.txt", "w2999.txtx", "w30", "re", "x"}) {
+        FileSlice found = names->getFilesWithPrefix(prefix);
+        size_t expectedCount = 0;
+        for (File* file : spread) {
+            expectedCount += lowered(file->getNameView()).compare(0, prefix.size(), lowered(prefix)) == 0;
+        }
+        bool sorted = std::is_sorted(found.begin(), found.end(), [&](File* lhs, File* rhs) { return lowered(lhs->getNameView()) < lowered(rhs->getNameView()); });
+        trieOk = trieOk && sorted && found.size() == expectedCount + (prefix == "re");
+    }
+    FileSlice outer = names->getFilesWithPrefix("w1");
+    FileSlice inner = names->getFilesWithPrefix("w12");
+    trieOk = trieOk && outer.begin() <= inner.begin() && inner.end() <= outer.end() && names->getFilesWithPrefix("w2999.txt")[0] == spread[2999];
+    if (trieOk) {
+        std::cout << "passed test 21" << std::endl;
+    }
+    else {
+        std::cout << "failed test 21" << std::endl;
+    }
+
+    // test nodes with many children switch to dense slots and still find every child, in order
+    FileTrie* fanout = new FileTrie();
+    std::vector<File*> initials;
+    for (char c : std::string("zyx9876543210abcdefghijklmnopqrstuvw")) {
+        initials.push_back(new File(std::string(1, c) + "x.md", ""));
+        fanout->addFile(initials.back());
+    }
+    size_t packedNodes = fanout->nodeCount();
+    bool denseOk = fanout->getFilesWithPrefix("").size() == 36 && fanout->getFilesWithPrefix("Q").size() == 1
+        && fanout->getFilesWithPrefix("qx.md")[0]->getName() == "qx.md" && fanout->getFilesWithPrefix("-").empty()
+        && fanout->getFilesWithPrefix("")[0]->getName() == "0x.md" && fanout->getFilesWithPrefix("")[35]->getName() == "zx.md"
+        && packedNodes == 37 && fanout->memoryUsage().nodes == packedNodes * sizeof(FileTrieNode);
+    if (denseOk) {
+        std::cout << "passed test 22" << std::endl;
+    }
+    else {
+        std::cout << "failed test 22" << std::endl;
+    }
+
+    // test the trie's memory accounting adds up, and that clearing it gives back all but one block and leaves it usable
+    FileTrieMemory usage = names->memoryUsage();
+    bool arenaOk = usage.nodes == names->nodeCount() * sizeof(FileTrieNode) && usage.labels > 0 && usage.files >= 3001 * sizeof(File*)
+        && usage.nodes + usage.labels + usage.children + usage.files + usage.wasted <= usage.reserved
+        && usage.total() == usage.reserved + usage.layout && usage.reserved % Arena::BLOCK_SIZE == 0;
+    names->clear();
+    names->addFile(doc);
+    arenaOk = arenaOk && names->nodeCount() == 2 && names->getFilesWithPrefix("").size() == 1
+        && names->getFilesWithPrefix("w").empty() && names->memoryUsage().reserved == Arena::BLOCK_SIZE;
+    if (arenaOk) {
+        std::cout << "passed test 23" << std::endl;
+    }
+    else {
+        std::cout << "failed test 23" << std::endl;
+    }
+
+    // test removing and renaming prune the trie back to the nodes still needed, and churn does not grow its memory
+    FileTrie* pruned = new FileTrie();
+    File* abc = new File("abc.txt", "");
+    File* abd = new File("ABD.txt", "");
+    pruned->addFile(abc);
+    pruned->addFile(abd);
+    size_t splitNodes = pruned->nodeCount();
+    bool pruneOk = splitNodes == 4 && pruned->removeFile(abd) && !pruned->removeFile(abd) && pruned->nodeCount() == 2
+        && pruned->getFilesWithPrefix("ab").size() == 1 && pruned->getFilesWithPrefix("abd").empty()
+        && pruned->getFilesWithPrefix("abc.txt")[0] == abc;
+    *abd = File("zz.md", "");
+    pruneOk = pruneOk && !pruned->renameFile(abd, "ABD.txt");
+    pruned->addFile(abd);
+    *abd = File("abe.md", "");
+    pruneOk = pruneOk && pruned->renameFile(abd, "ZZ.md") && pruned->getFilesWithPrefix("z").empty()
+        && pruned->getFilesWithPrefix("ab").size() == 2 && pruned->getFilesWithPrefix("abe")[0] == abd;
+    for (File* file : spread) {
+        pruned->addFile(file);
+    }
+    for (size_t i = 0; i < spread.size(); i += 2) {
+        pruneOk = pruneOk && pruned->removeFile(spread[i]);
+    }
+    FileSlice odd = pruned->getFilesWithPrefix("w");
+    pruneOk = pruneOk && odd.size() == spread.size() / 2 && odd[0] == spread[1]
+        && pruned->getFilesWithPrefix("w2998").empty() && pruned->getFilesWithPrefix("w2999")[0] == spread[2999];
+    size_t settled = 0;
+    for (int round = 0; round < 20; round++) {
+        for (size_t i = 0; i < spread.size(); i += 2) {
+            pruned->addFile(spread[i]);
+        }
+        for (size_t i = 0; i < spread.size(); i += 2) {
+            pruned->removeFile(spread[i]);
+        }
+        if (round == 1) {
+            settled = pruned->memoryUsage().reserved;
+        }
+    }
+    FileTrieMemory churned = pruned->memoryUsage();
+    pruneOk = pruneOk && pruned->getFilesWithPrefix("").size() == spread.size() / 2 + 2 && churned.reserved <= 2 * settled
+        && churned.nodes == pruned->nodeCount() * sizeof(FileTrieNode);
+    for (size_t i = 1; i < spread.size(); i += 2) {
+        pruned->removeFile(spread[i]);
+    }
+    pruned->removeFile(abc);
+    pruned->removeFile(abd);
+    pruneOk = pruneOk && pruned->nodeCount() == 1 && pruned->getFilesWithPrefix("").empty();
+    if (pruneOk) {
+        std::cout << "passed test 24" << std::endl;
+    }
+    else {
+        std::cout << "failed test 24" << std::endl;
+    }
+
+    // test counts and the first few suggestions match the full slice, and neither lays the files out again after a change
+    FileTrie* suggest = new FileTrie();
+    for (File* file : spread) {
+        suggest->addFile(file);
+    }
+    bool suggestOk = true;
+    for (std::string prefix : {"", "w1", "W12", "w2999.txt", "w2999.txtx", "x"}) {
+        FileSlice all = suggest->getFilesWithPrefix(prefix);
+        std::vector<File*> first = suggest->firstFilesWithPrefix(prefix, 10);
+        suggestOk = suggestOk && suggest->countWithPrefix(prefix) == all.size() && first.size() == std::min<size_t>(10, all.size())
+            && std::equal(first.begin(), first.end(), all.begin());
+    }
+    File* w10 = new File("w10.md", "");
+    suggest->addFile(w10);
+    suggest->removeFile(spread[10]);
+    size_t beforeSuggest = allocations;
+    size_t counted = suggest->countWithPrefix("w10");
+    std::vector<File*> first = suggest->firstFilesWithPrefix("w10", 3);
+    suggestOk = suggestOk && allocations - beforeSuggest == 1 && counted == 111 && first.size() == 3 && first[0] == w10
+        && first[1] == spread[100] && first[2] == spread[1000] && suggest->firstFilesWithPrefix("w", 0).empty()
+        && suggest->firstFilesWithPrefix("w2999", 5).size() == 1 && suggest->getFilesWithPrefix("w10").size() == counted;
+    if (suggestOk) {
+        std::cout << "passed test 25" << std::endl;
+    }
+    else {
+        std::cout << "failed test 25" << std::endl;
+    }
+
+    // test removals keep the label bytes equal to the live labels' lengths: every character on an edge is one distinct
+    //    prefix of a name still in the trie, so they add up to the number of such prefixes
+    FileTrie* labelled = new FileTrie();
+    File* abe = new File("abe.txt", "");
+    labelled->addFile(abc);
+    labelled->addFile(abd);
+    labelled->addFile(abe);
+    labelled->removeFile(abd);
+    labelled->removeFile(abe);
+    bool labelsOk = labelled->memoryUsage().labels == 7;
+    labelled->removeFile(abc);
+    labelsOk = labelsOk && labelled->memoryUsage().labels == 0;
+    for (File* file : spread) {
+        labelled->addFile(file);
+    }
+    std::set<std::string> prefixes;
+    for (size_t i = 0; i < spread.size(); i++) {
+        if (i % 3 == 0) {
+            labelled->removeFile(spread[i]);
+            continue;
+        }
+        std::string name = lowered(spread[i]->getNameView());
+        for (size_t k = 1; k <= name.size(); k++) {
+            prefixes.insert(name.substr(0, k));
+        }
+    }
+    labelsOk = labelsOk && labelled->memoryUsage().labels == prefixes.size();
+    if (labelsOk) {
+        std::cout << "passed test 26" << std::endl;
+    }
+    else {
+        std::cout << "failed test 26" << std::endl;
+    }
+
+    // test page tokens resume after the last file returned even when its bucket changes between pages
+    FileAVL* paging = new FileAVL();
+    std::vector<File*> bucket;
+    for (int i = 0; i < 10; i++) {
+        bucket.push_back(new File("p" + std::to_string(i) + ".txt", "12345"));
+        paging->insert(bucket.back());
+    }
+    File* larger = new File("larger.txt", "123456");
+    paging->insert(larger);
+    // forward: a file already returned is removed, so an offset alone would skip p3
+    FileCursor forward = paging->cursor(0, 10);
+    std::vector<File*> pages;
+    forward.take(pages, 3);
+    PageToken mark = forward.token();
+    paging->remove(bucket[1]);
+    paging->resume(mark).take(pages, SIZE_MAX);
+    std::vector<File*> expectedForward = {bucket[0], bucket[1], bucket[2], bucket[3], bucket[4], bucket[5], bucket[6], bucket[7], bucket[8], bucket[9], larger};
+    bool tokenOk = pages == expectedForward && mark.last_ == bucket[2];
+    // reverse: the bucket grows behind the walk, so an offset alone would return p9 again
+    FileCursor backwardPages = paging->cursor(0, 10, true);
+    pages.clear();
+    backwardPages.take(pages, 3);
+    mark = backwardPages.token();
+    paging->insert(new File("p10.txt", "12345"));
+    paging->resume(mark).take(pages, SIZE_MAX);
+    std::vector<File*> expectedBackward = {larger, bucket[9], bucket[8], bucket[7], bucket[6], bucket[5], bucket[4], bucket[3], bucket[2], bucket[0]};
+    tokenOk = tokenOk && pages == expectedBackward;
+    // the last file returned is itself removed: the walk picks up with the one after it
+    forward = paging->cursor(5, 5);
+    pages.clear();
+    forward.take(pages, 2);
+    mark = forward.token();
+    paging->remove(bucket[2]);
+    paging->resume(mark).take(pages, 1);
+    tokenOk = tokenOk && pages.size() == 3 && pages[0] == bucket[0] && pages[1] == bucket[2] && pages[2] == bucket[3];
+    if (tokenOk) {
+        std::cout << "passed test 27" << std::endl;
+    }
+    else {
+        std::cout << "failed test 27" << std::endl;
+    }
+
+    // test const lookups from several threads right after a change agree, with the stale layout redone only once
+    FileTrie* searched = new FileTrie();
+    for (File* file : spread) {
+        searched->addFile(file);
+    }
+    std::atomic<bool> searchesOk{true};
+    for (int round = 0; round < 3; round++) {
+        searched->removeFile(spread[round]);
+        std::vector<std::thread> searchers;
+        for (int t = 0; t < 4; t++) {
+            searchers.emplace_back([&searched, &searchesOk, &spread] {
+                const FileTrie& reader = *searched;
+                FileSlice all = reader.getFilesWithPrefix("w");
+                FileSlice some = reader.getFilesWithPrefix("w2");
+                if (all.size() != reader.countWithPrefix("w") || some.size() != reader.countWithPrefix("w2")
+                    || reader.getFilesWithPrefix("w2999")[0] != spread[2999]) {
+                    searchesOk = false;
+                }
+            });
+        }
+        for (std::thread& searcher : searchers) {
+            searcher.join();
+        }
+        searchesOk = searchesOk && searched->countWithPrefix("") == spread.size() - round - 1;
+    }
+    if (searchesOk) {
+        std::cout << "passed test 28" << std::endl;
+    }
+    else {
+        std::cout << "failed test 28" << std::endl;
+    }
+
+    // test a compaction leaves a file renamed but not yet moved under the key it was stored under
+    FileTrie* compacted = new FileTrie();
+    File* pending = new File("pending.txt", "");
+    compacted->addFile(pending);
+    for (File* file : spread) {
+        compacted->addFile(file);
+    }
+    *pending = File("moved.txt", "");
+    bool compactedOnce = false;
+    size_t lastWasted = compacted->memoryUsage().wasted;
+    for (int round = 0; round < 50 && !compactedOnce; round++) {
+        for (size_t i = round % 2; i < spread.size(); i += 2) {
+            compacted->removeFile(spread[i]);
+            compacted->addFile(spread[i]);
+        }
+        size_t wasted = compacted->memoryUsage().wasted;
+        compactedOnce = wasted < lastWasted;
+        lastWasted = wasted;
+    }
+    bool keysOk = compactedOnce && compacted->getFilesWithPrefix("pending.txt").size() == 1 && compacted->getFilesWithPrefix("moved").empty()
+        && compacted->renameFile(pending, "pending.txt") && compacted->getFilesWithPrefix("moved.txt")[0] == pending
+        && compacted->getFilesWithPrefix("pending").empty() && compacted->countWithPrefix("") == spread.size() + 1;
+    if (keysOk) {
+        std::cout << "passed test 29" << std::endl;
+    }
+    else {
+        std::cout << "failed test 29" << std::endl;
+    }
+}